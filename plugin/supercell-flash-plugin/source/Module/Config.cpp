@@ -126,6 +126,66 @@ namespace sc {
 				lowResolutionSuffix = data["lowResolutionSuffix"];
 				context.logger->info("	lowResolutionSuffix: {}", lowResolutionSuffix);
 			}
+
+			if (data["spriteHullVertices"].is_number_unsigned()) {
+				spriteHullVertices = data["spriteHullVertices"];
+				context.logger->info("	spriteHullVertices: {}", spriteHullVertices);
+			}
+
+			if (data["matrixTranslationTolerance"].is_number()) {
+				matrixTranslationTolerance = data["matrixTranslationTolerance"];
+				context.logger->info("	matrixTranslationTolerance: {}", matrixTranslationTolerance);
+			}
+
+			if (data["matrixScaleTolerance"].is_number()) {
+				matrixScaleTolerance = data["matrixScaleTolerance"];
+				context.logger->info("	matrixScaleTolerance: {}", matrixScaleTolerance);
+			}
+
+			if (data["colorTransformTolerance"].is_number_unsigned()) {
+				colorTransformTolerance = data["colorTransformTolerance"];
+				context.logger->info("	colorTransformTolerance: {}", colorTransformTolerance);
+			}
+
+			if (data["collapseStaticMovieclips"].is_boolean()) {
+				collapseStaticMovieclips = data["collapseStaticMovieclips"];
+				context.logger->info("	collapseStaticMovieclips: {}", collapseStaticMovieclips);
+			}
+
+			if (data["flattenWrapperMovieclips"].is_boolean()) {
+				flattenWrapperMovieclips = data["flattenWrapperMovieclips"];
+				context.logger->info("	flattenWrapperMovieclips: {}", flattenWrapperMovieclips);
+			}
+
+			if (data["batchStaticShapes"].is_boolean()) {
+				batchStaticShapes = data["batchStaticShapes"];
+				context.logger->info("	batchStaticShapes: {}", batchStaticShapes);
+			}
+
+			if (data["autoPrecisionMatrices"].is_boolean()) {
+				autoPrecisionMatrices = data["autoPrecisionMatrices"];
+				context.logger->info("	autoPrecisionMatrices: {}", autoPrecisionMatrices);
+			}
+
+			if (data["compactObjectIds"].is_boolean()) {
+				compactObjectIds = data["compactObjectIds"];
+				context.logger->info("	compactObjectIds: {}", compactObjectIds);
+			}
+
+			if (data["incrementalRepack"].is_boolean()) {
+				incrementalRepack = data["incrementalRepack"];
+				context.logger->info("	incrementalRepack: {}", incrementalRepack);
+			}
+
+			if (data["targetFrameRate"].is_number_unsigned()) {
+				targetFrameRate = data["targetFrameRate"];
+				context.logger->info("	targetFrameRate: {}", targetFrameRate);
+			}
+
+			if (data["atlasPackingStrategies"].is_number_unsigned()) {
+				atlasPackingStrategies = data["atlasPackingStrategies"];
+				context.logger->info("	atlasPackingStrategies: {}", atlasPackingStrategies);
+			}
 		}
 
 		void SCConfig::Normalize()
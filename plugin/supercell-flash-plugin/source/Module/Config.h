@@ -46,6 +46,7 @@ namespace sc {
 			bool exportToExternal = false;
 			fs::path exportToExternalPath = "";
 			bool repackAtlas = true;
+			bool incrementalRepack = true;
 
 			sc::flash::SWFTexture::TextureEncoding textureEncoding = sc::flash::SWFTexture::TextureEncoding::KhronosTexture;
 			bool hasExternalTexture = false;
@@ -60,8 +61,37 @@ namespace sc {
 			uint32_t textureMaxWidth = 4096;
 			uint32_t textureMaxHeight = 4096;
 
+			// Count of packing strategies that are tried in parallel for each atlas
+			uint8_t atlasPackingStrategies = 1;
+
 			bool writeCustomProperties = true;
 			bool hasPrecisionMatrices = false;
+
+			// Precision matrices are enabled only if compact ones are not precise enough
+			bool autoPrecisionMatrices = true;
+
+			// Display object ids are renumbered without gaps before saving
+			bool compactObjectIds = true;
+
+			// Movieclips with higher frame rate are resampled to this one. 0 keeps original timelines
+			uint8_t targetFrameRate = 0;
+
+			// Max vertices count of polygon around sprite. 4 or less keeps rectangles
+			uint8_t spriteHullVertices = 4;
+
+			// Max errors of matrices and color transforms snapping. 0 keeps transforms exact
+			float matrixTranslationTolerance = 0; // in twips
+			float matrixScaleTolerance = 0;
+			uint8_t colorTransformTolerance = 0;
+
+			// Movieclips with all frames identical are written with single frame
+			bool collapseStaticMovieclips = false;
+
+			// Single child movieclips are replaced with their children in parents
+			bool flattenWrapperMovieclips = false;
+
+			// Static shapes placed one after another are merged into one shape
+			bool batchStaticShapes = false;
 		public:
 			virtual void FromDict(const FCM::PIFCMDictionary dict) override;
 			void Load(const FCM::PIFCMDictionary dict);
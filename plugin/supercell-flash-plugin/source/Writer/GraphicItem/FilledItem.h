@@ -48,6 +48,19 @@ namespace sc
 				m_matrix = matrix;
 			};
 
+			FilledItem(
+				Animate::Publisher::SymbolContext& context,
+				const std::vector<FilledItemContour>& contour,
+				const wk::ColorRGBA& color,
+				const Animate::DOM::Utils::MATRIX2D& matrix = {}
+			) :
+				GraphicItem(context),
+				contours(contour),
+				m_color(color)
+			{
+				m_matrix = matrix;
+			};
+
 			virtual ~FilledItem() = default;
 
 		public:
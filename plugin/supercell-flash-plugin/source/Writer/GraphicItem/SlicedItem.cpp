@@ -14,6 +14,7 @@ namespace sc
 		{
 			m_matrix = matrix;
 			m_image = image;
+			m_image_hash = BitmapItem::HashImage(*m_image);
 			m_guides = SlicedItem::RoundScalingGrid(guides);
 		}
 
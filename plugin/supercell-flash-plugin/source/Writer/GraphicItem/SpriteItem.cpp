@@ -1,5 +1,8 @@
 #include "SpriteItem.h"
 
+#include "core/hashing/ncrypto/xxhash.h"
+#include "core/hashing/hash.h"
+
 namespace sc
 {
 	namespace Adobe
@@ -8,15 +11,25 @@ namespace sc
 			Animate::Publisher::SymbolContext& context,
 			wk::RawImageRef image,
 			const Animate::DOM::Utils::MATRIX2D& matrix,
-			bool rasterized
+			bool rasterized,
+			std::optional<std::size_t> image_hash
 		) : GraphicItem(context), m_image(image), m_is_rasterized(rasterized)
 		{
 			m_matrix = matrix;
+			m_image_hash = image_hash.has_value() ? image_hash.value() : BitmapItem::HashImage(*m_image);
 		};
 
 		BitmapItem::BitmapItem(Animate::Publisher::SymbolContext& context) : GraphicItem(context)
 		{
 
 		}
+
+		std::size_t BitmapItem::HashImage(const wk::RawImage& image)
+		{
+			wk::hash::XxHash code;
+			code.update((const wk::Image&)image);
+
+			return code.digest();
+		}
 	}
 }
\ No newline at end of file
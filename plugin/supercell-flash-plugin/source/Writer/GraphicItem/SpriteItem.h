@@ -7,6 +7,7 @@
 #include "core/memory/ref.h"
 #include "core/image/raw_image.h"
 #include <filesystem>
+#include <optional>
 
 namespace sc
 {
@@ -19,7 +20,8 @@ namespace sc
 				Animate::Publisher::SymbolContext& context,
 				wk::RawImageRef image,
 				const Animate::DOM::Utils::MATRIX2D& matrix,
-				bool rasterized = false
+				bool rasterized = false,
+				std::optional<std::size_t> image_hash = std::nullopt
 			);
 
 			BitmapItem(Animate::Publisher::SymbolContext& context);
@@ -36,8 +38,14 @@ namespace sc
 
 			bool IsRasterizedVector() const { return m_is_rasterized; }
 
+			// Hash of image content. Calculated once when item is created, if it was not given by image cache
+			std::size_t ImageHash() const { return m_image_hash; }
+
+			static std::size_t HashImage(const wk::RawImage& image);
+
 		protected:
 			wk::RawImageRef m_image;
+			std::size_t m_image_hash = 0;
 			bool m_is_rasterized = false;
 		};
 	}
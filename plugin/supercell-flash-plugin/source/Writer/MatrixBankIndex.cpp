@@ -0,0 +1,129 @@
+#include "MatrixBankIndex.h"
+
+#include "core/hashing/ncrypto/xxhash.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace sc {
+	namespace Adobe {
+		std::size_t MatrixBankIndex::MatrixKeyHash::operator()(const MatrixKey& key) const
+		{
+			wk::hash::XxHash code;
+			code.update((const uint8_t*)key.data(), sizeof(uint32_t) * key.size());
+
+			return code.digest();
+		}
+
+		MatrixBankIndex::MatrixKey MatrixBankIndex::matrix_key(const flash::Matrix2D& matrix)
+		{
+			// Negative zero is normalized, it is still equal to positive zero in float compare
+			const float elements[6] = {
+				matrix.a + 0.0f, matrix.b + 0.0f,
+				matrix.c + 0.0f, matrix.d + 0.0f,
+				matrix.tx + 0.0f, matrix.ty + 0.0f
+			};
+
+			MatrixKey key;
+			std::memcpy(key.data(), elements, sizeof(elements));
+
+			return key;
+		}
+
+		MatrixBankIndex::ColorKey MatrixBankIndex::color_key(const flash::ColorTransform& color)
+		{
+			return
+				(uint64_t)color.add.r |
+				((uint64_t)color.add.g << 8) |
+				((uint64_t)color.add.b << 16) |
+				((uint64_t)color.multiply.r << 24) |
+				((uint64_t)color.multiply.g << 32) |
+				((uint64_t)color.multiply.b << 40) |
+				((uint64_t)color.alpha << 48);
+		}
+
+		void MatrixBankIndex::sync(const flash::MatrixBank& bank)
+		{
+			// Bank was replaced, reallocated or shrunk, so index should be built from scratch
+			if (m_bank != &bank ||
+				m_matrices_data != bank.matrices.data() ||
+				m_colors_data != bank.color_transforms.data() ||
+				m_indexed_matrices > bank.matrices.size() ||
+				m_indexed_colors > bank.color_transforms.size())
+			{
+				clear();
+
+				m_bank = &bank;
+				m_matrices_data = bank.matrices.data();
+				m_colors_data = bank.color_transforms.data();
+			}
+
+			// In place changes keep storage, so they can't be noticed here and must be followed by clear()
+			assert(m_indexed_matrices == 0 || m_matrices.count(matrix_key(bank.matrices[m_indexed_matrices - 1])));
+			assert(m_indexed_colors == 0 || m_colors.count(color_key(bank.color_transforms[m_indexed_colors - 1])));
+
+			for (; bank.matrices.size() > m_indexed_matrices; m_indexed_matrices++)
+			{
+				// First entry wins, same as with linear search
+				m_matrices.emplace(matrix_key(bank.matrices[m_indexed_matrices]), (uint16_t)m_indexed_matrices);
+			}
+
+			for (; bank.color_transforms.size() > m_indexed_colors; m_indexed_colors++)
+			{
+				m_colors.emplace(color_key(bank.color_transforms[m_indexed_colors]), (uint16_t)m_indexed_colors);
+			}
+		}
+
+		void MatrixBankIndex::clear()
+		{
+			m_matrices.clear();
+			m_colors.clear();
+			m_indexed_matrices = 0;
+			m_indexed_colors = 0;
+
+			m_bank = nullptr;
+			m_matrices_data = nullptr;
+			m_colors_data = nullptr;
+		}
+
+		bool MatrixBankIndex::get_matrix_index(const flash::Matrix2D& matrix, uint16_t& index) const
+		{
+			auto it = m_matrices.find(matrix_key(matrix));
+			if (it == m_matrices.end()) return false;
+
+			index = it->second;
+			return true;
+		}
+
+		bool MatrixBankIndex::get_colorTransform_index(const flash::ColorTransform& color, uint16_t& index) const
+		{
+			auto it = m_colors.find(color_key(color));
+			if (it == m_colors.end()) return false;
+
+			index = it->second;
+			return true;
+		}
+
+		uint16_t MatrixBankIndex::push_matrix(flash::MatrixBank& bank, const flash::Matrix2D& matrix)
+		{
+			sync(bank);
+
+			uint16_t index = (uint16_t)bank.matrices.size();
+			bank.matrices.push_back(matrix);
+			sync(bank);
+
+			return index;
+		}
+
+		uint16_t MatrixBankIndex::push_colorTransform(flash::MatrixBank& bank, const flash::ColorTransform& color)
+		{
+			sync(bank);
+
+			uint16_t index = (uint16_t)bank.color_transforms.size();
+			bank.color_transforms.push_back(color);
+			sync(bank);
+
+			return index;
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "flash/flash.h"
+
+#include <array>
+#include <unordered_map>
+
+namespace sc {
+	namespace Adobe {
+		// Hash index over matrices and color transforms of MatrixBank.
+		// Keys are bit-exact so lookup gives the same result as linear search with exact compare.
+		// Index does not own bank, it remembers bank storage and how many entries are already indexed.
+		// Entries may only be appended between syncs, any other change of bank requires clear()
+		class MatrixBankIndex
+		{
+		public:
+			using MatrixKey = std::array<uint32_t, 6>;
+			using ColorKey = uint64_t;
+
+			struct MatrixKeyHash
+			{
+				std::size_t operator()(const MatrixKey& key) const;
+			};
+
+		public:
+			// Indexes all entries that were appended to bank since last call.
+			// Index is built from scratch if bank or its storage is not the same as on last call
+			void sync(const flash::MatrixBank& bank);
+
+			void clear();
+
+			bool get_matrix_index(const flash::Matrix2D& matrix, uint16_t& index) const;
+			bool get_colorTransform_index(const flash::ColorTransform& color, uint16_t& index) const;
+
+			// Appends entry to bank and keeps index in sync
+			uint16_t push_matrix(flash::MatrixBank& bank, const flash::Matrix2D& matrix);
+			uint16_t push_colorTransform(flash::MatrixBank& bank, const flash::ColorTransform& color);
+
+			static MatrixKey matrix_key(const flash::Matrix2D& matrix);
+			static ColorKey color_key(const flash::ColorTransform& color);
+
+		private:
+			std::unordered_map<MatrixKey, uint16_t, MatrixKeyHash> m_matrices;
+			std::unordered_map<ColorKey, uint16_t> m_colors;
+
+			size_t m_indexed_matrices = 0;
+			size_t m_indexed_colors = 0;
+
+			// Identity of indexed bank storage
+			const flash::MatrixBank* m_bank = nullptr;
+			const flash::Matrix2D* m_matrices_data = nullptr;
+			const flash::ColorTransform* m_colors_data = nullptr;
+		};
+	}
+}
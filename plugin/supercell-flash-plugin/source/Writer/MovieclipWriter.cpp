@@ -15,9 +15,11 @@ namespace sc {
 			Animate::Publisher::SharedMovieclipWriter(symbol),
 			m_writer(writer)
 		{
-			
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
 
-			
+			m_quantization.translation_tolerance = config.matrixTranslationTolerance;
+			m_quantization.scale_tolerance = config.matrixScaleTolerance;
+			m_quantization.color_tolerance = config.colorTransformTolerance;
 		};
 
 		SCMovieclipWriter::~SCMovieclipWriter()
@@ -69,47 +71,51 @@ namespace sc {
 		}
 
 		uint16_t SCMovieclipWriter::GetInstanceIndex(
-			uint16_t elementsCount,
 			uint16_t id,
 			FCM::BlendMode _blending,
-			std::string name
+			const std::u16string& name
 		) {
 			flash::DisplayObjectInstance::BlendMode blending = (flash::DisplayObjectInstance::BlendMode)(_blending);
 
-			uint16_t frameInstancesOffset = 0;
-			uint32_t frameElementsLastIndex = m_object.frame_elements.size() - 1;
-			for (uint32_t i = 0; elementsCount > i; i++) {
-				uint16_t& instanceIndex = m_object.frame_elements[frameElementsLastIndex - i].instance_index;
-				flash::DisplayObjectInstance& instance = m_object.childrens[instanceIndex];
-
-				if (
-					instance.id == id &&
-					instance.name.string() == name &&
-					instance.blend_mode == blending) {
-					frameInstancesOffset++;
-				}
+			// Occupancy is tracked only for current frame
+			if (m_occupancy_frame != m_position)
+			{
+				m_occupancy_frame = m_position;
+				m_frame_occupancy.clear();
 			}
 
-			uint16_t instancesCount = m_object.childrens.size();
-			for (uint16_t i = 0; instancesCount > i; i++) {
-				flash::DisplayObjectInstance& instance = m_object.childrens[i];
-
-				if (instance.id == id &&
-					instance.name.string() == name &&
-					instance.blend_mode == (flash::DisplayObjectInstance::BlendMode)blending) {
-					if (frameInstancesOffset != 0) {
-						frameInstancesOffset--;
-						continue;
-					}
+			auto name_it = m_instance_names.find(name);
+			uint32_t name_index = 0;
+			if (name_it == m_instance_names.end())
+			{
+				name_index = (uint32_t)m_instance_names.size();
+				m_instance_names[name] = name_index;
+			}
+			else
+			{
+				name_index = name_it->second;
+			}
 
-					return i;
-				}
+			uint64_t key = (uint64_t)id | ((uint64_t)name_index << 16) | ((uint64_t)blending << 48);
+
+			// Same element can be placed several times in one frame,
+			// so each next placement takes next instance with same key
+			uint16_t& occupancy = m_frame_occupancy[key];
+			std::vector<uint16_t>& slots = m_instance_slots[key];
+
+			if (slots.size() > occupancy)
+			{
+				return slots[occupancy++];
 			}
 
+			uint16_t instancesCount = m_object.childrens.size();
 			flash::DisplayObjectInstance& instance = m_object.childrens.emplace_back();
 			instance.id = id;
 			instance.blend_mode = blending;
-			instance.name = flash::SWFString(name);
+			instance.name = flash::SWFString(FCM::Locale::ToUtf8(name));
+
+			slots.push_back(instancesCount);
+			occupancy++;
 
 			return instancesCount;
 		}
@@ -129,21 +135,10 @@ namespace sc {
 		) {
 			flash::MovieClipFrame& frame = m_object.frames[m_position];
 
-			// Index of bind element
-			uint16_t instanceIndex = GetInstanceIndex(
-				frame.elements_count,
-				id, blending, FCM::Locale::ToUtf8(name)
-			);
-
-			// New frame element
-			flash::MovieClipFrameElement& element = m_object.frame_elements.emplace_back();
-			element.instance_index = instanceIndex;
-
-			frame.elements_count += 1;
+			flash::Matrix2D transformMatrix;
+			flash::ColorTransform transformColor;
 
 			if (matrix) {
-				flash::Matrix2D transformMatrix;
-
 				transformMatrix.a = matrix->a;
 				transformMatrix.b = matrix->b;
 				transformMatrix.c = matrix->c;
@@ -151,16 +146,10 @@ namespace sc {
 				transformMatrix.tx = matrix->tx;
 				transformMatrix.ty = matrix->ty;
 
-				if (!m_bank.get_matrix_index(transformMatrix, element.matrix_index))
-				{
-					element.matrix_index = m_bank.matrices.size();
-					m_bank.matrices.push_back(transformMatrix);
-				}
+				m_quantization.quantize(transformMatrix);
 			}
 
 			if (color) {
-				flash::ColorTransform transformColor;
-
 				transformColor.alpha = (uint8_t)std::clamp(
 					(int)((color->matrix[3][3] * 255) + color->matrix[3][4]),
 					0, 255
@@ -174,14 +163,76 @@ namespace sc {
 				transformColor.add.g = (uint8_t)std::clamp(int(color->matrix[1][4]), 0, 255);
 				transformColor.add.b = (uint8_t)std::clamp(int(color->matrix[2][4]), 0, 255);
 
-				if (!m_bank.get_colorTransform_index(transformColor, element.colorTransform_index))
+				m_quantization.quantize(transformColor);
+			}
+
+			if (!IsElementVisible(id, name, matrix ? &transformMatrix : nullptr, color ? &transformColor : nullptr))
+			{
+				m_writer.culled_elements++;
+				return;
+			}
+
+			// Index of bind element
+			uint16_t instanceIndex = GetInstanceIndex(
+				id, blending, name
+			);
+
+			// New frame element
+			flash::MovieClipFrameElement& element = m_object.frame_elements.emplace_back();
+			element.instance_index = instanceIndex;
+
+			frame.elements_count += 1;
+
+			if (matrix)
+			{
+				if (!m_bank_index.get_matrix_index(transformMatrix, element.matrix_index))
+				{
+					element.matrix_index = m_bank_index.push_matrix(m_bank, transformMatrix);
+				}
+			}
+
+			if (color)
+			{
+				if (!m_bank_index.get_colorTransform_index(transformColor, element.colorTransform_index))
 				{
-					element.colorTransform_index = m_bank.color_transforms.size();
-					m_bank.color_transforms.push_back(transformColor);
+					element.colorTransform_index = m_bank_index.push_colorTransform(m_bank, transformColor);
 				}
 			}
 		}
 
+		bool SCMovieclipWriter::IsElementVisible(
+			uint16_t id,
+			const std::u16string& name,
+			const flash::Matrix2D* matrix,
+			const flash::ColorTransform* color
+		)
+		{
+			if (m_mask_frame != m_position)
+			{
+				m_mask_frame = m_position;
+				m_mask_content = false;
+			}
+
+			flash::MovieClipModifier::Type modifier;
+			if (m_writer.GetModifierType(id, modifier))
+			{
+				m_mask_content = modifier == flash::MovieClipModifier::Type::Mask;
+				return true;
+			}
+
+			// Mask shape is used only for its geometry, so alpha does not matter there
+			if (m_mask_content) return true;
+
+			// Named instances may be accessed from game code even if they are hidden
+			if (!name.empty()) return true;
+
+			if (color && color->alpha == 0) return false;
+
+			if (matrix && (matrix->a * matrix->d) - (matrix->b * matrix->c) == 0.0f) return false;
+
+			return !m_writer.IsEmptyObject(id);
+		}
+
 		std::size_t SCMovieclipWriter::GenerateHash() const
 		{
 			wk::hash::XxHash code;
@@ -235,12 +286,214 @@ namespace sc {
 
 			//if (!new_symbol) return true;
 
+			m_writer.quantization.merge(m_quantization);
+
+			DecimateFrames();
+			FinalizeFrames();
+
+			if (m_object.frame_elements.empty())
+			{
+				m_writer.AddEmptyObject(id);
+			}
+
 			FinalizeTransforms();
 			m_writer.swf.movieclips.push_back(m_object);
 
 			return true;
 		}
 
+		bool SCMovieclipWriter::IsFramesEqual(size_t first_offset, size_t second_offset, uint16_t count) const
+		{
+			for (uint16_t i = 0; count > i; i++)
+			{
+				const flash::MovieClipFrameElement& first = m_object.frame_elements[first_offset + i];
+				const flash::MovieClipFrameElement& second = m_object.frame_elements[second_offset + i];
+
+				if (first.instance_index != second.instance_index ||
+					first.matrix_index != second.matrix_index ||
+					first.colorTransform_index != second.colorTransform_index)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void SCMovieclipWriter::DecimateFrames()
+		{
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+
+			uint32_t source_rate = m_object.frame_rate;
+			uint32_t target_rate = config.targetFrameRate;
+			if (target_rate == 0 || source_rate <= target_rate || m_object.frames.size() <= 1) return;
+
+			size_t source_count = m_object.frames.size();
+			size_t target_count = ((source_count * target_rate) + source_rate - 1) / source_rate;
+
+			// Each target frame shows source frame that is placed at the same time
+			std::vector<size_t> sources(target_count);
+			for (size_t i = 0; target_count > i; i++)
+			{
+				sources[i] = (i * source_rate) / target_rate;
+			}
+
+			// Labeled frames must stay, otherwise game code will jump to wrong poses
+			std::vector<bool> is_labeled(target_count, false);
+			for (size_t i = 0; source_count > i; i++)
+			{
+				if (m_object.frames[i].label.empty()) continue;
+
+				size_t target = (i * target_rate) / source_rate;
+				if (is_labeled[target])
+				{
+					SCPlugin::Instance().logger->warn(
+						"Movieclip {} was not decimated because some of its labels are too close",
+						FCM::Locale::ToUtf8(m_symbol.name)
+					);
+					return;
+				}
+
+				is_labeled[target] = true;
+				sources[target] = i;
+			}
+
+			std::vector<size_t> offsets(source_count);
+			for (size_t i = 0, offset = 0; source_count > i; i++)
+			{
+				offsets[i] = offset;
+				offset += m_object.frames[i].elements_count;
+			}
+
+			decltype(m_object.frames) frames;
+			decltype(m_object.frame_elements) frame_elements;
+			for (size_t target = 0; target_count > target; target++)
+			{
+				size_t source = sources[target];
+				const flash::MovieClipFrame& frame = m_object.frames[source];
+				flash::MovieClipFrame& target_frame = frames.emplace_back(frame);
+
+				// Labeled source can be also picked by neighbour target, but label must stay only on its own target
+				if (!is_labeled[target])
+				{
+					target_frame.label = flash::SWFString();
+				}
+
+				for (uint16_t i = 0; frame.elements_count > i; i++)
+				{
+					frame_elements.push_back(m_object.frame_elements[offsets[source] + i]);
+				}
+			}
+
+			m_object.frames = frames;
+			m_object.frame_elements = frame_elements;
+			m_object.frame_rate = (uint8_t)target_rate;
+
+			CompactTransforms();
+		}
+
+		void SCMovieclipWriter::CompactTransforms()
+		{
+			flash::MatrixBank bank;
+			MatrixBankIndex index;
+
+			std::vector<uint16_t> instance_remap(m_object.childrens.size(), 0xFFFF);
+			decltype(m_object.childrens) childrens;
+
+			for (flash::MovieClipFrameElement& element : m_object.frame_elements)
+			{
+				uint16_t& instance_index = instance_remap[element.instance_index];
+				if (instance_index == 0xFFFF)
+				{
+					instance_index = (uint16_t)childrens.size();
+					childrens.push_back(m_object.childrens[element.instance_index]);
+				}
+				element.instance_index = instance_index;
+
+				if (element.matrix_index != 0xFFFF)
+				{
+					const flash::Matrix2D& matrix = m_bank.matrices[element.matrix_index];
+					if (!index.get_matrix_index(matrix, element.matrix_index))
+					{
+						element.matrix_index = index.push_matrix(bank, matrix);
+					}
+				}
+
+				if (element.colorTransform_index != 0xFFFF)
+				{
+					const flash::ColorTransform& color = m_bank.color_transforms[element.colorTransform_index];
+					if (!index.get_colorTransform_index(color, element.colorTransform_index))
+					{
+						element.colorTransform_index = index.push_colorTransform(bank, color);
+					}
+				}
+			}
+
+			m_object.childrens = childrens;
+			m_bank = bank;
+			m_bank_index = index;
+		}
+
+		void SCMovieclipWriter::FinalizeFrames()
+		{
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+
+			if (m_object.frames.size() <= 1) return;
+
+			uint32_t longest_run_start = 0;
+			uint32_t longest_run_length = 1;
+			uint32_t run_start = 0;
+
+			// Labels on frames after first one can be used by game code, so frame count must be kept
+			bool has_labels = false;
+
+			size_t previous_offset = 0;
+			size_t offset = m_object.frames[0].elements_count;
+			for (uint32_t i = 1; m_object.frames.size() > i; i++)
+			{
+				const flash::MovieClipFrame& previous = m_object.frames[i - 1];
+				const flash::MovieClipFrame& frame = m_object.frames[i];
+
+				has_labels |= !frame.label.empty();
+
+				bool is_equal = frame.elements_count == previous.elements_count &&
+					IsFramesEqual(previous_offset, offset, frame.elements_count);
+
+				if (!is_equal)
+				{
+					run_start = i;
+				}
+				else if (i - run_start + 1 > longest_run_length)
+				{
+					longest_run_start = run_start;
+					longest_run_length = i - run_start + 1;
+				}
+
+				previous_offset = offset;
+				offset += frame.elements_count;
+			}
+
+			// Game code can read frame count or wait for timeline end of exported clips, so they keep their frames
+			bool is_exported = !m_symbol.linkage_name.empty();
+
+			bool is_static = longest_run_length == m_object.frames.size();
+			if (is_static && !has_labels && !is_exported && config.collapseStaticMovieclips)
+			{
+				m_object.frames.resize(1);
+				m_object.frame_elements.resize(m_object.frames[0].elements_count);
+				m_writer.collapsed_movieclips++;
+				return;
+			}
+
+			if (longest_run_length >= SCWriter::IdenticalFramesReportLength)
+			{
+				SCWriter::IdenticalFramesRun& run = m_writer.identical_frame_runs.emplace_back();
+				run.symbol = m_symbol.name;
+				run.first_frame = longest_run_start;
+				run.length = longest_run_length;
+			}
+		}
+
 		void SCMovieclipWriter::FinalizeTransforms() {
 			if (m_writer.swf.matrixBanks.empty())
 			{
@@ -262,6 +515,7 @@ namespace sc {
 			for (uint32_t i = 0; m_writer.swf.matrixBanks.size() > i; i++)
 			{
 				flash::MatrixBank& bank = m_writer.swf.matrixBanks[i];
+				MatrixBankIndex& index = m_writer.GetMatrixBankIndex(i);
 
 				matrix_indices.clear();
 				color_indices.clear();
@@ -277,7 +531,7 @@ namespace sc {
 						goto NEXT_BANK;
 					};
 
-					if (!bank.get_matrix_index(matrix, new_matrix_index))
+					if (!index.get_matrix_index(matrix, new_matrix_index))
 					{
 						new_matrices_count++;
 					}
@@ -294,7 +548,7 @@ namespace sc {
 						goto NEXT_BANK;
 					};
 
-					if (!bank.get_colorTransform_index(color, new_color_index))
+					if (!index.get_colorTransform_index(color, new_color_index))
 					{
 						new_colors_count++;
 					}
@@ -320,6 +574,7 @@ namespace sc {
 
 			m_object.bank_index = bank_index;
 			flash::MatrixBank& bank = m_writer.swf.matrixBanks[m_object.bank_index];
+			MatrixBankIndex& index = m_writer.GetMatrixBankIndex(m_object.bank_index);
 			for (flash::MovieClipFrameElement& element : m_object.frame_elements)
 			{
 				if (element.matrix_index != 0xFFFF)
@@ -328,8 +583,7 @@ namespace sc {
 
 					if (matrix_index == 0xFFFF)
 					{
-						matrix_index = bank.matrices.size();
-						bank.matrices.push_back(m_bank.matrices[element.matrix_index]);
+						matrix_index = index.push_matrix(bank, m_bank.matrices[element.matrix_index]);
 					}
 
 					element.matrix_index = matrix_index;
@@ -341,8 +595,7 @@ namespace sc {
 
 					if (color_index == 0xFFFF)
 					{
-						color_index = bank.color_transforms.size();
-						bank.color_transforms.push_back(m_bank.color_transforms[element.colorTransform_index]);
+						color_index = index.push_colorTransform(bank, m_bank.color_transforms[element.colorTransform_index]);
 					}
 
 					element.colorTransform_index = color_index;
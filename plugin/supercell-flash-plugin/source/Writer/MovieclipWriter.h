@@ -5,6 +5,10 @@
 #include "AnimatePublisher.h"
 
 #include "Window/Components/StatusComponent.h"
+#include "Writer/MatrixBankIndex.h"
+#include "Writer/Optimization/TransformQuantization.h"
+
+#include <unordered_map>
 
 namespace sc {
 	namespace Adobe {
@@ -20,16 +24,54 @@ namespace sc {
 
 			// Bank with current object transformations only
 			flash::MatrixBank m_bank;
+			MatrixBankIndex m_bank_index;
+
+			// Snapping of transforms before insertion to bank
+			flash::TransformQuantization m_quantization;
+
+			// Instance lookup index
+
+			// Name / Index of interned name
+			std::unordered_map<std::u16string, uint32_t> m_instance_names;
+
+			// Instance key / Instance indices with same key in order of creation
+			std::unordered_map<uint64_t, std::vector<uint16_t>> m_instance_slots;
+
+			// Instance key / Count of already used instances in current frame
+			std::unordered_map<uint64_t, uint16_t> m_frame_occupancy;
+			uint32_t m_occupancy_frame = 0xFFFFFFFF;
+
+			// Is current element placed between Mask and Masked modifiers
+			bool m_mask_content = false;
+			uint32_t m_mask_frame = 0xFFFFFFFF;
 
 			// Helper functions
 
 			uint16_t GetInstanceIndex(
-				uint16_t elementsCount,
 				uint16_t id,
 				FCM::BlendMode blending,
-				std::string name
+				const std::u16string& name
 			);
 
+			// Returns false for elements that can never be seen at runtime
+			bool IsElementVisible(
+				uint16_t id,
+				const std::u16string& name,
+				const flash::Matrix2D* matrix,
+				const flash::ColorTransform* color
+			);
+
+			bool IsFramesEqual(size_t first_offset, size_t second_offset, uint16_t count) const;
+
+			// Resamples timeline to frame rate from config
+			void DecimateFrames();
+
+			// Removes instances and bank entries that are not used by frame elements anymore
+			void CompactTransforms();
+
+			// Collapses clips where all frames are the same and reports long static frame runs
+			void FinalizeFrames();
+
 			void FinalizeTransforms();
 
 		public:
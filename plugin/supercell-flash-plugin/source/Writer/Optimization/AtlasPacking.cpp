@@ -0,0 +1,200 @@
+#include "AtlasPacking.h"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <numeric>
+
+namespace sc::flash
+{
+	using namespace wk;
+
+	namespace
+	{
+		enum class PackingOrder : uint8_t
+		{
+			Original = 0,
+			Area,
+			MaxSide,
+			Height
+		};
+
+		struct PackingStrategy
+		{
+			PackingOrder order = PackingOrder::Original;
+			uint32_t width = 0;
+			uint32_t height = 0;
+		};
+
+		// Min page size that is tried for half sized pages
+		constexpr uint32_t MinStrategyPageSize = 1024;
+
+		std::vector<PackingStrategy> get_strategies(const AtlasPackingSettings& settings)
+		{
+			std::vector<PackingStrategy> result;
+
+			// First strategy is the same as single pass, so it is always valid fallback
+			result.push_back({ PackingOrder::Original, settings.max_width, settings.max_height });
+			result.push_back({ PackingOrder::Area, settings.max_width, settings.max_height });
+			result.push_back({ PackingOrder::MaxSide, settings.max_width, settings.max_height });
+			result.push_back({ PackingOrder::Height, settings.max_width, settings.max_height });
+
+			if (settings.max_width / 2 >= MinStrategyPageSize && settings.max_height / 2 >= MinStrategyPageSize)
+			{
+				result.push_back({ PackingOrder::Area, settings.max_width / 2, settings.max_height / 2 });
+			}
+
+			result.resize(std::min<size_t>(result.size(), std::max<uint8_t>(settings.strategies, 1)));
+			return result;
+		}
+
+		std::vector<size_t> get_order(const std::vector<AtlasPackingItem>& items, PackingOrder order)
+		{
+			std::vector<size_t> result(items.size());
+			std::iota(result.begin(), result.end(), 0);
+
+			auto sort = [&result](auto key)
+				{
+					std::stable_sort(result.begin(), result.end(), [&key](size_t a, size_t b) { return key(a) > key(b); });
+				};
+
+			switch (order)
+			{
+			case PackingOrder::Area:
+				sort([&items](size_t i) { return (uint64_t)items[i].width * items[i].height; });
+				break;
+			case PackingOrder::MaxSide:
+				sort([&items](size_t i) { return std::max(items[i].width, items[i].height); });
+				break;
+			case PackingOrder::Height:
+				sort([&items](size_t i) { return ((uint64_t)items[i].height << 32) | items[i].width; });
+				break;
+			default:
+				break;
+			}
+
+			return result;
+		}
+
+		struct StrategyResult
+		{
+			AtlasPackingResult packing;
+			std::vector<size_t> order;
+			AtlasGenerator::Container<AtlasGenerator::Item> items;
+		};
+
+		template<typename T>
+		void run_strategy(
+			AtlasPackingResult& packing,
+			const PackingStrategy& strategy,
+			const AtlasPackingSettings& settings,
+			AtlasGenerator::Container<T>& input,
+			bool report_progress
+		)
+		{
+			packing.config = std::make_unique<AtlasGenerator::Config>(
+				strategy.width, strategy.height, settings.scale, settings.extrude
+			);
+
+			if (report_progress && settings.progress)
+			{
+				packing.config->progress = settings.progress;
+			}
+
+			packing.generator = std::make_unique<AtlasGenerator::Generator>(*packing.config);
+			packing.atlas_count = packing.generator->generate<T>(input);
+
+			for (size_t atlas_index = 0; packing.atlas_count > atlas_index; atlas_index++)
+			{
+				RawImage& atlas = packing.generator->get_atlas(atlas_index);
+				packing.atlas_area += (uint64_t)atlas.width() * atlas.height();
+			}
+		}
+
+		bool is_better(const AtlasPackingResult& current, const AtlasPackingResult& best)
+		{
+			return current.atlas_count < best.atlas_count ||
+				(current.atlas_count == best.atlas_count && current.atlas_area < best.atlas_area);
+		}
+	}
+
+	void pack_atlas(std::vector<AtlasPackingItem>& items, const AtlasPackingSettings& settings, AtlasPackingResult& result)
+	{
+		std::vector<PackingStrategy> strategies = get_strategies(settings);
+
+		std::launch policy = std::launch::deferred;
+#if !WK_DEBUG
+		policy |= std::launch::async;
+#endif // !WK_DEBUG
+
+		// Other strategies pack their own copies of items, which are made here before first strategy changes items in place
+		std::vector<std::future<StrategyResult>> futures;
+		for (size_t i = 1; strategies.size() > i; i++)
+		{
+			StrategyResult prepared;
+			prepared.packing.strategy = i;
+			prepared.order = get_order(items, strategies[i].order);
+
+			prepared.items.reserve(items.size());
+			for (size_t index : prepared.order)
+			{
+				prepared.items.push_back(items[index].item.get());
+			}
+
+			futures.push_back(std::async(policy, [&settings, strategy = strategies[i], prepared = std::move(prepared)]() mutable
+				{
+					run_strategy(prepared.packing, strategy, settings, prepared.items, false);
+					return std::move(prepared);
+				}
+			));
+		}
+
+		// First strategy packs original items on calling thread, so progress is reported from it as before
+		std::exception_ptr first_exception;
+		bool has_result = false;
+		try
+		{
+			AtlasGenerator::Container<std::reference_wrapper<AtlasGenerator::Item>> input;
+			input.reserve(items.size());
+			for (AtlasPackingItem& item : items)
+			{
+				input.push_back(item.item);
+			}
+
+			result.strategy = 0;
+			run_strategy(result, strategies[0], settings, input, true);
+			has_result = true;
+		}
+		catch (...)
+		{
+			first_exception = std::current_exception();
+		}
+
+		// Better result is written back to items right away, so losing generators and item copies are released one by one
+		for (std::future<StrategyResult>& future : futures)
+		{
+			try
+			{
+				StrategyResult current = future.get();
+				if (has_result && !is_better(current.packing, result)) continue;
+
+				for (size_t i = 0; current.order.size() > i; i++)
+				{
+					items[current.order[i]].item.get() = current.items[i];
+				}
+
+				result = std::move(current.packing);
+				has_result = true;
+			}
+			catch (...)
+			{
+				if (!first_exception) first_exception = std::current_exception();
+			}
+		}
+
+		if (!has_result)
+		{
+			std::rethrow_exception(first_exception);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "atlas_generator/Generator.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sc::flash
+{
+	struct AtlasPackingItem
+	{
+		std::reference_wrapper<wk::AtlasGenerator::Item> item;
+
+		// Size of item image in pixels, used to order items for different strategies
+		uint32_t width = 1;
+		uint32_t height = 1;
+	};
+
+	struct AtlasPackingSettings
+	{
+		uint32_t max_width = 4096;
+		uint32_t max_height = 4096;
+		float scale = 1.0f;
+		uint8_t extrude = 2;
+
+		// Max count of strategies to try, 1 keeps single pass with original item order
+		uint8_t strategies = 1;
+
+		std::function<void(uint32_t)> progress;
+	};
+
+	struct AtlasPackingResult
+	{
+		std::unique_ptr<wk::AtlasGenerator::Config> config;
+		std::unique_ptr<wk::AtlasGenerator::Generator> generator;
+		size_t atlas_count = 0;
+		uint64_t atlas_area = 0;
+		size_t strategy = 0;
+	};
+
+	// Packs items with several strategies in parallel, varying item order and page size inside of limits.
+	// First strategy packs items in place on calling thread, others work on copies of items.
+	// Keeps result with fewest pages, then with least area, then first strategy on ties.
+	// Items get texture index and transform from best result
+	void pack_atlas(std::vector<AtlasPackingItem>& items, const AtlasPackingSettings& settings, AtlasPackingResult& result);
+}
@@ -0,0 +1,206 @@
+#include "Flattening.h"
+
+#include "MatrixBanks.h"
+#include "Transform.h"
+#include "Writer/MatrixBankIndex.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sc::flash
+{
+	using Adobe::MatrixBankIndex;
+
+	namespace
+	{
+		bool is_identity_color(const ColorTransform& color)
+		{
+			return color.alpha == 255 &&
+				color.multiply.r == 255 && color.multiply.g == 255 && color.multiply.b == 255 &&
+				color.add.r == 0 && color.add.g == 0 && color.add.b == 0;
+		}
+
+	}
+
+	bool is_wrapper_movieclip(const MovieClip& movieclip, const std::unordered_set<uint16_t>& modifiers)
+	{
+		if (movieclip.frames.size() != 1 || movieclip.frame_elements.size() != 1) return false;
+		if (movieclip.childrens.size() != 1 || movieclip.scaling_grid.has_value()) return false;
+		if (!movieclip.frames[0].label.empty()) return false;
+
+		const DisplayObjectInstance& child = movieclip.childrens[0];
+		if (!child.name.empty()) return false;
+
+		return !modifiers.count(child.id);
+	}
+
+	bool flatten_wrappers(SupercellSWF& swf, FlatteningStatistics& statistics)
+	{
+		std::unordered_set<uint16_t> exported;
+		for (const ExportName& export_name : swf.exports)
+		{
+			exported.insert(export_name.id);
+		}
+
+		std::unordered_set<uint16_t> modifiers;
+		for (const MovieClipModifier& modifier : swf.movieclip_modifiers)
+		{
+			modifiers.insert(modifier.id);
+		}
+
+		// Wrapper id / Movieclip index
+		std::unordered_map<uint16_t, size_t> wrappers;
+		for (size_t i = 0; swf.movieclips.size() > i; i++)
+		{
+			const MovieClip& movieclip = swf.movieclips[i];
+			if (!exported.count(movieclip.id) && is_wrapper_movieclip(movieclip, modifiers))
+			{
+				wrappers[movieclip.id] = i;
+			}
+		}
+
+		if (wrappers.empty()) return false;
+
+		std::vector<MatrixBankIndex> indices(swf.matrixBanks.size());
+
+		for (MovieClip& movieclip : swf.movieclips)
+		{
+			// Scaling grid is applied only to direct children, so hierarchy must stay the same
+			if (movieclip.scaling_grid.has_value()) continue;
+			if (movieclip.bank_index >= swf.matrixBanks.size()) continue;
+
+			MatrixBank& bank = swf.matrixBanks[movieclip.bank_index];
+			MatrixBankIndex& index = indices[movieclip.bank_index];
+			index.sync(bank);
+
+			for (uint16_t instance_index = 0; movieclip.childrens.size() > instance_index; instance_index++)
+			{
+				DisplayObjectInstance& instance = movieclip.childrens[instance_index];
+
+				// Named instances can be accessed from game code as movieclips
+				if (!instance.name.empty()) continue;
+
+				// Ids of this parent and wrappers that were already inlined into instance.
+				// Wrappers can point to each other, so chain stops on repeated id
+				std::unordered_set<uint16_t> chain = { movieclip.id };
+
+				// Wrappers of wrappers are inlined one level at a time
+				while (wrappers.count(instance.id) && chain.insert(instance.id).second)
+				{
+					const MovieClip& wrapper = swf.movieclips[wrappers[instance.id]];
+					const DisplayObjectInstance& child = wrapper.childrens[0];
+					const MovieClipFrameElement& wrapper_element = wrapper.frame_elements[0];
+					const MatrixBank& wrapper_bank = swf.matrixBanks[wrapper.bank_index];
+
+					bool is_parent_blending = (uint8_t)instance.blend_mode != NormalBlendMode;
+					bool is_child_blending = (uint8_t)child.blend_mode != NormalBlendMode;
+					if (is_parent_blending && is_child_blending) break;
+
+					// Copies, because wrapper and parent can share the same bank
+					std::optional<Matrix2D> wrapper_matrix;
+					if (wrapper_element.matrix_index != 0xFFFF)
+					{
+						wrapper_matrix = wrapper_bank.matrices[wrapper_element.matrix_index];
+					}
+
+					std::optional<ColorTransform> wrapper_color;
+					if (wrapper_element.colorTransform_index != 0xFFFF &&
+						!is_identity_color(wrapper_bank.color_transforms[wrapper_element.colorTransform_index]))
+					{
+						wrapper_color = wrapper_bank.color_transforms[wrapper_element.colorTransform_index];
+					}
+
+					uint16_t child_id = child.id;
+					DisplayObjectInstance::BlendMode child_blend_mode = child.blend_mode;
+
+					// Composition of two color transforms can't be stored without rounding errors,
+					// so wrapper color is moved to parent only where parent has no color of its own
+					bool is_valid = true;
+					size_t new_matrices_count = 0;
+					size_t new_colors_count = 0;
+					for (const MovieClipFrameElement& element : movieclip.frame_elements)
+					{
+						if (element.instance_index != instance_index) continue;
+
+						if (wrapper_color)
+						{
+							if (element.colorTransform_index != 0xFFFF &&
+								!is_identity_color(bank.color_transforms[element.colorTransform_index]))
+							{
+								is_valid = false;
+								break;
+							}
+
+							new_colors_count = 1;
+						}
+
+						if (wrapper_matrix) new_matrices_count++;
+					}
+
+					if (!is_valid) break;
+					if (bank.matrices.size() + new_matrices_count > MatrixBankCapacity) break;
+					if (bank.color_transforms.size() + new_colors_count > MatrixBankCapacity) break;
+
+					for (MovieClipFrameElement& element : movieclip.frame_elements)
+					{
+						if (element.instance_index != instance_index) continue;
+
+						if (wrapper_matrix)
+						{
+							Matrix2D matrix = element.matrix_index != 0xFFFF ?
+								multiply_matrix(bank.matrices[element.matrix_index], *wrapper_matrix) : *wrapper_matrix;
+
+							if (!index.get_matrix_index(matrix, element.matrix_index))
+							{
+								element.matrix_index = index.push_matrix(bank, matrix);
+							}
+						}
+
+						if (wrapper_color)
+						{
+							if (!index.get_colorTransform_index(*wrapper_color, element.colorTransform_index))
+							{
+								element.colorTransform_index = index.push_colorTransform(bank, *wrapper_color);
+							}
+						}
+					}
+
+					instance.id = child_id;
+					if (is_child_blending)
+					{
+						instance.blend_mode = child_blend_mode;
+					}
+
+					statistics.inlined_instances++;
+				}
+			}
+		}
+
+		// Removing wrappers that are not used anymore
+		std::unordered_set<uint16_t> referenced;
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			for (const DisplayObjectInstance& instance : movieclip.childrens)
+			{
+				referenced.insert(instance.id);
+			}
+		}
+
+		size_t movieclips_count = swf.movieclips.size();
+		swf.movieclips.erase(
+			std::remove_if(swf.movieclips.begin(), swf.movieclips.end(),
+				[&wrappers, &referenced](const MovieClip& movieclip)
+				{
+					return wrappers.count(movieclip.id) && !referenced.count(movieclip.id);
+				}
+			),
+			swf.movieclips.end()
+		);
+
+		statistics.removed_wrappers = movieclips_count - swf.movieclips.size();
+
+		return statistics.inlined_instances > 0;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "flash/flash.h"
+
+#include <unordered_set>
+
+namespace sc::flash
+{
+	struct FlatteningStatistics
+	{
+		size_t inlined_instances = 0;
+		size_t removed_wrappers = 0;
+	};
+
+	// Movieclip with one frame and one unnamed child that only moves or colors this child
+	bool is_wrapper_movieclip(const MovieClip& movieclip, const std::unordered_set<uint16_t>& modifiers);
+
+	// Replaces unnamed instances of wrapper movieclips with their children.
+	// Wrapper transforms are composed into parent bank, wrappers without references are removed
+	bool flatten_wrappers(SupercellSWF& swf, FlatteningStatistics& statistics);
+}
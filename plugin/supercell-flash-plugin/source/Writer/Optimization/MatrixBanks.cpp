@@ -0,0 +1,297 @@
+#include "MatrixBanks.h"
+
+#include "Writer/MatrixBankIndex.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace sc::flash
+{
+	using Adobe::MatrixBankIndex;
+
+	size_t get_bank_entries_count(const SupercellSWF& swf)
+	{
+		size_t result = 0;
+		for (const MatrixBank& bank : swf.matrixBanks)
+		{
+			result += bank.matrices.size() + bank.color_transforms.size();
+		}
+
+		return result;
+	}
+
+	bool optimize_bank_assignment(SupercellSWF& swf, MatrixBankStatistics& statistics)
+	{
+		statistics.banks_before = swf.matrixBanks.size();
+		statistics.entries_before = get_bank_entries_count(swf);
+		statistics.banks_after = statistics.banks_before;
+		statistics.entries_after = statistics.entries_before;
+
+		if (swf.matrixBanks.empty() || swf.movieclips.empty()) return false;
+
+		// Unique transforms that each movieclip actually uses from its current bank
+		struct Usage
+		{
+			std::vector<uint16_t> matrices;
+			std::vector<uint16_t> colors;
+		};
+
+		std::vector<Usage> usages(swf.movieclips.size());
+		for (size_t i = 0; swf.movieclips.size() > i; i++)
+		{
+			const MovieClip& movieclip = swf.movieclips[i];
+			Usage& usage = usages[i];
+
+			if (movieclip.bank_index >= swf.matrixBanks.size()) return false;
+
+			for (const MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				if (element.matrix_index != 0xFFFF) usage.matrices.push_back(element.matrix_index);
+				if (element.colorTransform_index != 0xFFFF) usage.colors.push_back(element.colorTransform_index);
+			}
+
+			std::sort(usage.matrices.begin(), usage.matrices.end());
+			usage.matrices.erase(std::unique(usage.matrices.begin(), usage.matrices.end()), usage.matrices.end());
+
+			std::sort(usage.colors.begin(), usage.colors.end());
+			usage.colors.erase(std::unique(usage.colors.begin(), usage.colors.end()), usage.colors.end());
+		}
+
+		// Biggest clips first, publish order on ties to keep result deterministic
+		std::vector<size_t> order(swf.movieclips.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&usages](size_t a, size_t b)
+			{
+				return usages[a].matrices.size() + usages[a].colors.size() >
+					usages[b].matrices.size() + usages[b].colors.size();
+			}
+		);
+
+		std::vector<MatrixBank> banks;
+		std::vector<MatrixBankIndex> indices;
+
+		// Old index / New index for each movieclip
+		std::vector<std::unordered_map<uint16_t, uint16_t>> matrix_remap(swf.movieclips.size());
+		std::vector<std::unordered_map<uint16_t, uint16_t>> color_remap(swf.movieclips.size());
+		std::vector<uint16_t> bank_assignment(swf.movieclips.size());
+
+		for (size_t movieclip_index : order)
+		{
+			const MovieClip& movieclip = swf.movieclips[movieclip_index];
+			const MatrixBank& source = swf.matrixBanks[movieclip.bank_index];
+			const Usage& usage = usages[movieclip_index];
+
+			size_t best_bank = SIZE_MAX;
+			size_t best_new_entries = SIZE_MAX;
+
+			for (size_t b = 0; banks.size() > b; b++)
+			{
+				size_t new_matrices = 0;
+				size_t new_colors = 0;
+				uint16_t index = 0;
+
+				for (uint16_t matrix_index : usage.matrices)
+				{
+					if (!indices[b].get_matrix_index(source.matrices[matrix_index], index)) new_matrices++;
+				}
+
+				for (uint16_t color_index : usage.colors)
+				{
+					if (!indices[b].get_colorTransform_index(source.color_transforms[color_index], index)) new_colors++;
+				}
+
+				if (banks[b].matrices.size() + new_matrices > MatrixBankCapacity) continue;
+				if (banks[b].color_transforms.size() + new_colors > MatrixBankCapacity) continue;
+
+				if (best_new_entries > new_matrices + new_colors)
+				{
+					best_new_entries = new_matrices + new_colors;
+					best_bank = b;
+				}
+			}
+
+			if (best_bank == SIZE_MAX)
+			{
+				best_bank = banks.size();
+				banks.emplace_back();
+				indices.emplace_back();
+			}
+
+			MatrixBank& bank = banks[best_bank];
+			MatrixBankIndex& bank_index = indices[best_bank];
+			bank_assignment[movieclip_index] = (uint16_t)best_bank;
+
+			for (uint16_t matrix_index : usage.matrices)
+			{
+				const Matrix2D& matrix = source.matrices[matrix_index];
+				uint16_t index = 0;
+				if (!bank_index.get_matrix_index(matrix, index))
+				{
+					index = bank_index.push_matrix(bank, matrix);
+				}
+
+				matrix_remap[movieclip_index][matrix_index] = index;
+			}
+
+			for (uint16_t color_index : usage.colors)
+			{
+				const ColorTransform& color = source.color_transforms[color_index];
+				uint16_t index = 0;
+				if (!bank_index.get_colorTransform_index(color, index))
+				{
+					index = bank_index.push_colorTransform(bank, color);
+				}
+
+				color_remap[movieclip_index][color_index] = index;
+			}
+		}
+
+		// Underfilled banks are merged into earlier ones when union of their entries fits.
+		// Merged bank stays empty and is dropped below
+		std::vector<bool> merged_banks(banks.size(), false);
+		for (size_t b = banks.size(); b-- > 1;)
+		{
+			for (size_t a = 0; b > a; a++)
+			{
+				if (merged_banks[a]) continue;
+
+				size_t new_matrices = 0;
+				size_t new_colors = 0;
+				uint16_t index = 0;
+
+				for (const Matrix2D& matrix : banks[b].matrices)
+				{
+					if (!indices[a].get_matrix_index(matrix, index)) new_matrices++;
+				}
+
+				for (const ColorTransform& color : banks[b].color_transforms)
+				{
+					if (!indices[a].get_colorTransform_index(color, index)) new_colors++;
+				}
+
+				if (banks[a].matrices.size() + new_matrices > MatrixBankCapacity) continue;
+				if (banks[a].color_transforms.size() + new_colors > MatrixBankCapacity) continue;
+
+				std::vector<uint16_t> merged_matrices(banks[b].matrices.size());
+				for (size_t i = 0; banks[b].matrices.size() > i; i++)
+				{
+					const Matrix2D& matrix = banks[b].matrices[i];
+					if (!indices[a].get_matrix_index(matrix, merged_matrices[i]))
+					{
+						merged_matrices[i] = indices[a].push_matrix(banks[a], matrix);
+					}
+				}
+
+				std::vector<uint16_t> merged_colors(banks[b].color_transforms.size());
+				for (size_t i = 0; banks[b].color_transforms.size() > i; i++)
+				{
+					const ColorTransform& color = banks[b].color_transforms[i];
+					if (!indices[a].get_colorTransform_index(color, merged_colors[i]))
+					{
+						merged_colors[i] = indices[a].push_colorTransform(banks[a], color);
+					}
+				}
+
+				for (size_t i = 0; swf.movieclips.size() > i; i++)
+				{
+					if (bank_assignment[i] != b) continue;
+
+					bank_assignment[i] = (uint16_t)a;
+					for (auto& [_, index] : matrix_remap[i]) index = merged_matrices[index];
+					for (auto& [_, index] : color_remap[i]) index = merged_colors[index];
+				}
+
+				merged_banks[b] = true;
+				break;
+			}
+		}
+
+		// Final banks get entries in order of first use by movieclips and their frame elements,
+		// so entries of one clip and of neighbour clips lie close to each other
+		std::vector<uint16_t> bank_remap(banks.size(), 0xFFFF);
+		std::vector<MatrixBank> result;
+		std::vector<std::vector<uint16_t>> matrix_order(banks.size());
+		std::vector<std::vector<uint16_t>> color_order(banks.size());
+
+		for (size_t b = 0; banks.size() > b; b++)
+		{
+			if (merged_banks[b]) continue;
+
+			bank_remap[b] = (uint16_t)result.size();
+			result.emplace_back();
+			matrix_order[b].resize(banks[b].matrices.size(), 0xFFFF);
+			color_order[b].resize(banks[b].color_transforms.size(), 0xFFFF);
+		}
+
+		for (size_t i = 0; swf.movieclips.size() > i; i++)
+		{
+			const MovieClip& movieclip = swf.movieclips[i];
+			uint16_t b = bank_assignment[i];
+			MatrixBank& bank = result[bank_remap[b]];
+
+			for (const MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				if (element.matrix_index != 0xFFFF)
+				{
+					uint16_t index = matrix_remap[i][element.matrix_index];
+					if (matrix_order[b][index] == 0xFFFF)
+					{
+						matrix_order[b][index] = (uint16_t)bank.matrices.size();
+						bank.matrices.push_back(banks[b].matrices[index]);
+					}
+				}
+
+				if (element.colorTransform_index != 0xFFFF)
+				{
+					uint16_t index = color_remap[i][element.colorTransform_index];
+					if (color_order[b][index] == 0xFFFF)
+					{
+						color_order[b][index] = (uint16_t)bank.color_transforms.size();
+						bank.color_transforms.push_back(banks[b].color_transforms[index]);
+					}
+				}
+			}
+		}
+
+		// Default bank is kept even if nothing uses it
+		if (result.empty()) result.emplace_back();
+
+		size_t entries_after = 0;
+		for (const MatrixBank& bank : result)
+		{
+			entries_after += bank.matrices.size() + bank.color_transforms.size();
+		}
+
+		// Layout with the same size is still applied because of better entry order
+		bool is_worse =
+			result.size() > statistics.banks_before ||
+			(result.size() == statistics.banks_before && entries_after > statistics.entries_before);
+
+		if (is_worse) return false;
+
+		for (size_t i = 0; swf.movieclips.size() > i; i++)
+		{
+			MovieClip& movieclip = swf.movieclips[i];
+			uint16_t b = bank_assignment[i];
+			movieclip.bank_index = bank_remap[b];
+
+			for (MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				if (element.matrix_index != 0xFFFF) element.matrix_index = matrix_order[b][matrix_remap[i][element.matrix_index]];
+				if (element.colorTransform_index != 0xFFFF) element.colorTransform_index = color_order[b][color_remap[i][element.colorTransform_index]];
+			}
+		}
+
+		swf.matrixBanks.clear();
+		for (MatrixBank& bank : result)
+		{
+			swf.matrixBanks.push_back(bank);
+		}
+
+		statistics.banks_after = result.size();
+		statistics.entries_after = entries_after;
+
+		return true;
+	}
+}
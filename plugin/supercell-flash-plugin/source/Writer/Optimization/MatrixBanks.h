@@ -0,0 +1,25 @@
+#pragma once
+
+#include "flash/flash.h"
+
+namespace sc::flash
+{
+	// Max count of matrices or color transforms in one bank. 0xFFFF is reserved for "no transform"
+	constexpr size_t MatrixBankCapacity = 0xFFFE;
+
+	struct MatrixBankStatistics
+	{
+		size_t banks_before = 0;
+		size_t banks_after = 0;
+		size_t entries_before = 0;
+		size_t entries_after = 0;
+	};
+
+	size_t get_bank_entries_count(const SupercellSWF& swf);
+
+	// Rebuilds banks from transforms that frame elements actually use, so clips with most shared transforms are placed together.
+	// Clips are placed from biggest to smallest to the bank where they add fewest new entries,
+	// then underfilled banks are merged and entries are ordered by first use.
+	// Result is applied only if it does not use more banks or entries than current layout
+	bool optimize_bank_assignment(SupercellSWF& swf, MatrixBankStatistics& statistics);
+}
@@ -0,0 +1,182 @@
+#include "PrecisionMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace sc::flash
+{
+	namespace
+	{
+		struct Bound
+		{
+			float min_x = 0;
+			float min_y = 0;
+			float max_x = 0;
+			float max_y = 0;
+			bool valid = false;
+
+			void extend(float x, float y)
+			{
+				if (!valid)
+				{
+					min_x = max_x = x;
+					min_y = max_y = y;
+					valid = true;
+					return;
+				}
+
+				min_x = std::min(min_x, x);
+				min_y = std::min(min_y, y);
+				max_x = std::max(max_x, x);
+				max_y = std::max(max_y, y);
+			}
+		};
+
+		float round_compact(float value)
+		{
+			return std::round(value / CompactMatrixStep) * CompactMatrixStep;
+		}
+
+		class BoundCalculator
+		{
+		public:
+			BoundCalculator(const SupercellSWF& swf) : m_swf(swf)
+			{
+				for (const Shape& shape : swf.shapes)
+				{
+					Bound& bound = m_bounds[shape.id];
+					for (const ShapeDrawBitmapCommand& command : shape.commands)
+					{
+						for (const ShapeDrawBitmapCommandVertex& vertex : command.vertices)
+						{
+							bound.extend(vertex.x, vertex.y);
+						}
+					}
+				}
+
+				for (size_t i = 0; swf.movieclips.size() > i; i++)
+				{
+					m_movieclips[swf.movieclips[i].id] = i;
+				}
+			}
+
+			// Bound of display object content in its own space. Text fields are not measured
+			const Bound& get(uint16_t id)
+			{
+				auto it = m_bounds.find(id);
+				if (it != m_bounds.end()) return it->second;
+
+				// Inserted before children are processed, so broken cyclic references can't hang
+				Bound& result = m_bounds[id];
+
+				auto movieclip_it = m_movieclips.find(id);
+				if (movieclip_it == m_movieclips.end()) return result;
+
+				const MovieClip& movieclip = m_swf.movieclips[movieclip_it->second];
+				if (movieclip.bank_index >= m_swf.matrixBanks.size()) return result;
+				const MatrixBank& bank = m_swf.matrixBanks[movieclip.bank_index];
+
+				Bound bound;
+				for (const MovieClipFrameElement& element : movieclip.frame_elements)
+				{
+					const Bound& child = get(movieclip.childrens[element.instance_index].id);
+					if (!child.valid) continue;
+
+					if (element.matrix_index == 0xFFFF)
+					{
+						bound.extend(child.min_x, child.min_y);
+						bound.extend(child.max_x, child.max_y);
+						continue;
+					}
+
+					const Matrix2D& matrix = bank.matrices[element.matrix_index];
+					for (float x : { child.min_x, child.max_x })
+					{
+						for (float y : { child.min_y, child.max_y })
+						{
+							bound.extend(
+								(matrix.a * x) + (matrix.c * y) + matrix.tx,
+								(matrix.b * x) + (matrix.d * y) + matrix.ty
+							);
+						}
+					}
+				}
+
+				result = bound;
+				return result;
+			}
+
+		private:
+			const SupercellSWF& m_swf;
+
+			// Id / Movieclip index
+			std::unordered_map<uint16_t, size_t> m_movieclips;
+
+			// Id / Content bound
+			std::unordered_map<uint16_t, Bound> m_bounds;
+		};
+
+		// Max displacement of bound corners after rounding of matrix to compact encoding
+		float get_rounding_error(const Matrix2D& matrix, const Bound& bound)
+		{
+			float delta_a = round_compact(matrix.a) - matrix.a;
+			float delta_b = round_compact(matrix.b) - matrix.b;
+			float delta_c = round_compact(matrix.c) - matrix.c;
+			float delta_d = round_compact(matrix.d) - matrix.d;
+
+			float result = 0;
+			for (float x : { bound.min_x, bound.max_x })
+			{
+				for (float y : { bound.min_y, bound.max_y })
+				{
+					float error_x = (delta_a * x) + (delta_c * y);
+					float error_y = (delta_b * x) + (delta_d * y);
+
+					result = std::max(result, std::sqrt((error_x * error_x) + (error_y * error_y)));
+				}
+			}
+
+			return result;
+		}
+	}
+
+	void analyze_matrix_precision(const SupercellSWF& swf, MatrixPrecisionReport& report)
+	{
+		BoundCalculator bounds(swf);
+
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			if (movieclip.bank_index >= swf.matrixBanks.size()) continue;
+			const MatrixBank& bank = swf.matrixBanks[movieclip.bank_index];
+
+			float movieclip_error = 0;
+			for (const MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				if (element.matrix_index == 0xFFFF) continue;
+
+				const Bound& bound = bounds.get(movieclip.childrens[element.instance_index].id);
+				if (!bound.valid) continue;
+
+				movieclip_error = std::max(
+					movieclip_error,
+					get_rounding_error(bank.matrices[element.matrix_index], bound)
+				);
+			}
+
+			if (movieclip_error > 0)
+			{
+				report.movieclips.emplace_back(movieclip.id, movieclip_error);
+				report.max_error = std::max(report.max_error, movieclip_error);
+			}
+		}
+
+		std::stable_sort(
+			report.movieclips.begin(), report.movieclips.end(),
+			[](const std::pair<uint16_t, float>& a, const std::pair<uint16_t, float>& b)
+			{
+				return a.second > b.second;
+			}
+		);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "flash/flash.h"
+
+#include <vector>
+
+namespace sc::flash
+{
+	// Step of matrix scale and skew elements in compact matrix encoding.
+	// Elements are stored as integers of 1/1024, so rounding moves each of them by up to 1/2048
+	constexpr float CompactMatrixStep = 1.0f / 1024.0f;
+
+	struct MatrixPrecisionReport
+	{
+		// Biggest displacement in pixels of child content caused by compact encoding
+		float max_error = 0;
+
+		// Movieclip id / Max error of its frame elements, sorted from worst
+		std::vector<std::pair<uint16_t, float>> movieclips;
+	};
+
+	// Measures how far content of every frame element moves when
+	// bank matrices are stored in compact encoding instead of precision one
+	void analyze_matrix_precision(const SupercellSWF& swf, MatrixPrecisionReport& report);
+}
@@ -0,0 +1,438 @@
+#include "ShapeBatching.h"
+#include "Transform.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sc::flash
+{
+	namespace
+	{
+		bool inverse(const Matrix2D& matrix, Matrix2D& result)
+		{
+			float determinant = matrix.a * matrix.d - matrix.b * matrix.c;
+			if (determinant == 0.0f) return false;
+
+			result.a = matrix.d / determinant;
+			result.b = -matrix.b / determinant;
+			result.c = -matrix.c / determinant;
+			result.d = matrix.a / determinant;
+			result.tx = (matrix.c * matrix.ty - matrix.d * matrix.tx) / determinant;
+			result.ty = (matrix.b * matrix.tx - matrix.a * matrix.ty) / determinant;
+
+			return true;
+		}
+
+		// Relative transforms must be exactly the same. Any tolerance lets baked transform
+		// differ from the one of later frames, so instances would move away from their original place
+		bool is_equal(const Matrix2D& first, const Matrix2D& second)
+		{
+			return first.a == second.a &&
+				first.b == second.b &&
+				first.c == second.c &&
+				first.d == second.d &&
+				first.tx == second.tx &&
+				first.ty == second.ty;
+		}
+
+		// Frame elements of one movieclip, split by frames
+		struct FrameView
+		{
+			size_t offset = 0;
+			uint16_t count = 0;
+		};
+
+		class MovieClipBatcher
+		{
+		public:
+			MovieClipBatcher(
+				const SupercellSWF& swf,
+				const MovieClip& movieclip,
+				const std::unordered_set<uint16_t>& shapes,
+				const std::unordered_map<uint16_t, MovieClipModifier::Type>& modifiers
+			) : m_movieclip(movieclip), m_bank(swf.matrixBanks[movieclip.bank_index])
+			{
+				size_t offset = 0;
+				for (const MovieClipFrame& frame : movieclip.frames)
+				{
+					FrameView& view = m_frames.emplace_back();
+					view.offset = offset;
+					view.count = frame.elements_count;
+					offset += frame.elements_count;
+				}
+
+				// Elements between modifiers are drawn as mask or masked content
+				m_masked.resize(movieclip.frame_elements.size(), false);
+				for (const FrameView& view : m_frames)
+				{
+					bool is_masked = false;
+					for (uint16_t i = 0; view.count > i; i++)
+					{
+						const MovieClipFrameElement& element = movieclip.frame_elements[view.offset + i];
+						const DisplayObjectInstance& instance = movieclip.childrens[element.instance_index];
+
+						auto modifier = modifiers.find(instance.id);
+						if (modifier != modifiers.end())
+						{
+							is_masked = modifier->second != MovieClipModifier::Type::Unmasked;
+							m_masked[view.offset + i] = true;
+							continue;
+						}
+
+						m_masked[view.offset + i] = is_masked;
+					}
+				}
+
+				m_element_frames.resize(movieclip.frame_elements.size());
+				m_occurrences.resize(movieclip.childrens.size());
+				std::vector<uint32_t> last_frame(movieclip.childrens.size(), UINT32_MAX);
+				std::vector<bool> repeated(movieclip.childrens.size(), false);
+				for (uint32_t f = 0; m_frames.size() > f; f++)
+				{
+					const FrameView& view = m_frames[f];
+					for (uint16_t i = 0; view.count > i; i++)
+					{
+						uint16_t instance_index = movieclip.frame_elements[view.offset + i].instance_index;
+						m_element_frames[view.offset + i] = f;
+
+						// Instance that is drawn twice in one frame can't be merged
+						if (last_frame[instance_index] == f) repeated[instance_index] = true;
+						last_frame[instance_index] = f;
+
+						m_occurrences[instance_index].push_back(view.offset + i);
+					}
+				}
+
+				m_batchable.resize(movieclip.childrens.size(), false);
+				for (size_t i = 0; movieclip.childrens.size() > i; i++)
+				{
+					const DisplayObjectInstance& instance = movieclip.childrens[i];
+
+					m_batchable[i] = shapes.count(instance.id) &&
+						instance.name.empty() &&
+						(uint8_t)instance.blend_mode == NormalBlendMode &&
+						!repeated[i];
+				}
+			}
+
+			// Greedy search of static runs starting from elements of first frame where they are placed.
+			// Run is extended by checking only new instance against occurrences of first one,
+			// and result of each start instance does not depend on frame where it is found, so it is tried only once
+			void find_runs(std::vector<std::vector<uint16_t>>& runs, std::vector<std::vector<Matrix2D>>& transforms) const
+			{
+				std::vector<bool> used(m_movieclip.childrens.size(), false);
+				std::vector<bool> tried(m_movieclip.childrens.size(), false);
+
+				for (const FrameView& view : m_frames)
+				{
+					for (uint16_t i = 0; view.count > i;)
+					{
+						uint16_t instance_index = m_movieclip.frame_elements[view.offset + i].instance_index;
+						if (used[instance_index] || tried[instance_index] || !m_batchable[instance_index])
+						{
+							i++;
+							continue;
+						}
+
+						tried[instance_index] = true;
+
+						std::vector<uint16_t> run = { instance_index };
+						std::vector<Matrix2D> relative = { Matrix2D() };
+						extend_run(run, relative, used);
+
+						if (run.size() > 1)
+						{
+							for (uint16_t index : run)
+							{
+								used[index] = true;
+							}
+
+							runs.push_back(run);
+							transforms.push_back(relative);
+						}
+
+						i += (uint16_t)run.size();
+					}
+				}
+			}
+
+		private:
+			// Appends following instances to run while they are placed right after previous ones
+			// with the same relative transform in every frame where run starts
+			void extend_run(std::vector<uint16_t>& run, std::vector<Matrix2D>& relative, const std::vector<bool>& used) const
+			{
+				const std::vector<size_t>& positions = m_occurrences[run[0]];
+
+				std::vector<Matrix2D> inverses(positions.size());
+				for (size_t f = 0; positions.size() > f; f++)
+				{
+					if (m_masked[positions[f]]) return;
+					if (!inverse(get_matrix(m_movieclip.frame_elements[positions[f]]), inverses[f])) return;
+				}
+
+				for (size_t k = 1;; k++)
+				{
+					size_t first_position = positions[0] + k;
+					if (!is_same_frame(positions[0], first_position)) return;
+
+					uint16_t next_index = m_movieclip.frame_elements[first_position].instance_index;
+					if (used[next_index] || !m_batchable[next_index]) return;
+
+					// Instance must not be shown in frames where run is not shown
+					if (m_occurrences[next_index].size() != positions.size()) return;
+
+					Matrix2D candidate;
+					for (size_t f = 0; positions.size() > f; f++)
+					{
+						size_t position = positions[f] + k;
+						if (!is_same_frame(positions[f], position)) return;
+
+						const MovieClipFrameElement& first = m_movieclip.frame_elements[positions[f]];
+						const MovieClipFrameElement& element = m_movieclip.frame_elements[position];
+
+						if (element.instance_index != next_index) return;
+						if (element.colorTransform_index != first.colorTransform_index) return;
+						if (m_masked[position]) return;
+
+						Matrix2D matrix = multiply_matrix(inverses[f], get_matrix(element));
+						if (f == 0)
+						{
+							candidate = matrix;
+						}
+						else if (!is_equal(candidate, matrix))
+						{
+							return;
+						}
+					}
+
+					run.push_back(next_index);
+					relative.push_back(candidate);
+				}
+			}
+
+			bool is_same_frame(size_t first_position, size_t second_position) const
+			{
+				return m_element_frames.size() > second_position &&
+					m_element_frames[first_position] == m_element_frames[second_position];
+			}
+
+			Matrix2D get_matrix(const MovieClipFrameElement& element) const
+			{
+				if (element.matrix_index == 0xFFFF) return Matrix2D();
+
+				return m_bank.matrices[element.matrix_index];
+			}
+
+		private:
+			const MovieClip& m_movieclip;
+			const MatrixBank& m_bank;
+
+			std::vector<FrameView> m_frames;
+
+			// Frame of each element
+			std::vector<uint32_t> m_element_frames;
+
+			// Element positions of each instance
+			std::vector<std::vector<size_t>> m_occurrences;
+
+			std::vector<bool> m_masked;
+			std::vector<bool> m_batchable;
+		};
+
+		// Removes elements and instances that were merged into first instances of runs
+		void remove_instances(MovieClip& movieclip, const std::unordered_set<uint16_t>& removed)
+		{
+			decltype(movieclip.frame_elements) elements;
+			elements.reserve(movieclip.frame_elements.size());
+
+			size_t offset = 0;
+			for (MovieClipFrame& frame : movieclip.frames)
+			{
+				uint16_t count = 0;
+				for (uint16_t i = 0; frame.elements_count > i; i++)
+				{
+					MovieClipFrameElement element = movieclip.frame_elements[offset + i];
+					if (removed.count(element.instance_index)) continue;
+
+					elements.push_back(element);
+					count++;
+				}
+
+				offset += frame.elements_count;
+				frame.elements_count = count;
+			}
+
+			movieclip.frame_elements = elements;
+
+			std::vector<uint16_t> remap(movieclip.childrens.size(), 0xFFFF);
+			decltype(movieclip.childrens) childrens;
+			for (uint16_t i = 0; movieclip.childrens.size() > i; i++)
+			{
+				if (removed.count(i)) continue;
+
+				remap[i] = (uint16_t)childrens.size();
+				childrens.push_back(movieclip.childrens[i]);
+			}
+
+			movieclip.childrens = childrens;
+			for (MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				element.instance_index = remap[element.instance_index];
+			}
+		}
+	}
+
+	bool batch_static_shapes(SupercellSWF& swf, ShapeBatchingStatistics& statistics)
+	{
+		// Shape id / Shape index
+		std::unordered_map<uint16_t, size_t> shapes;
+		std::unordered_set<uint16_t> shape_ids;
+		std::unordered_map<uint16_t, MovieClipModifier::Type> modifiers;
+		uint32_t max_id = 0;
+
+		for (size_t i = 0; swf.shapes.size() > i; i++)
+		{
+			shapes[swf.shapes[i].id] = i;
+			shape_ids.insert(swf.shapes[i].id);
+			max_id = std::max<uint32_t>(max_id, swf.shapes[i].id);
+		}
+
+		for (const MovieClipModifier& modifier : swf.movieclip_modifiers)
+		{
+			modifiers[modifier.id] = modifier.type;
+			max_id = std::max<uint32_t>(max_id, modifier.id);
+		}
+
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			max_id = std::max<uint32_t>(max_id, movieclip.id);
+		}
+
+		for (const TextField& textfield : swf.textfields)
+		{
+			max_id = std::max<uint32_t>(max_id, textfield.id);
+		}
+
+		// Merged shape key / Shape id, same runs in different movieclips use the same shape
+		std::unordered_map<std::string, uint16_t> merged_shapes;
+		std::unordered_set<uint16_t> source_shapes;
+
+		for (MovieClip& movieclip : swf.movieclips)
+		{
+			// Scaling grid is applied to each shape separately
+			if (movieclip.scaling_grid.has_value()) continue;
+			if (movieclip.bank_index >= swf.matrixBanks.size()) continue;
+
+			std::vector<std::vector<uint16_t>> runs;
+			std::vector<std::vector<Matrix2D>> transforms;
+			{
+				MovieClipBatcher batcher(swf, movieclip, shape_ids, modifiers);
+				batcher.find_runs(runs, transforms);
+			}
+
+			if (runs.empty()) continue;
+
+			// Instance index / Merged shape id
+			std::vector<std::pair<uint16_t, uint16_t>> merged_instances;
+			std::unordered_set<uint16_t> removed;
+
+			for (size_t r = 0; runs.size() > r; r++)
+			{
+				const std::vector<uint16_t>& run = runs[r];
+				const std::vector<Matrix2D>& relative = transforms[r];
+
+				std::string key;
+				for (size_t k = 0; run.size() > k; k++)
+				{
+					uint16_t id = movieclip.childrens[run[k]].id;
+					key.append((const char*)&id, sizeof(id));
+					key.append((const char*)&relative[k].elements, sizeof(relative[k].elements));
+				}
+
+				uint16_t shape_id = 0;
+				auto it = merged_shapes.find(key);
+				if (it != merged_shapes.end())
+				{
+					shape_id = it->second;
+				}
+				else
+				{
+					if (max_id + 1 >= 0xFFFF) break;
+					shape_id = (uint16_t)++max_id;
+
+					Shape merged;
+					merged.id = shape_id;
+
+					for (size_t k = 0; run.size() > k; k++)
+					{
+						uint16_t id = movieclip.childrens[run[k]].id;
+						const Shape& source = swf.shapes[shapes[id]];
+						const Matrix2D& matrix = relative[k];
+						source_shapes.insert(id);
+
+						for (const ShapeDrawBitmapCommand& source_command : source.commands)
+						{
+							ShapeDrawBitmapCommand& command = merged.commands.emplace_back(source_command);
+							for (ShapeDrawBitmapCommandVertex& vertex : command.vertices)
+							{
+								float x = vertex.x;
+								float y = vertex.y;
+								vertex.x = (matrix.a * x) + (matrix.c * y) + matrix.tx;
+								vertex.y = (matrix.b * x) + (matrix.d * y) + matrix.ty;
+							}
+						}
+					}
+
+					shapes[shape_id] = swf.shapes.size();
+					swf.shapes.push_back(merged);
+					merged_shapes[key] = shape_id;
+					statistics.created_shapes++;
+				}
+
+				// Merged shape is created in space of first instance, so it keeps its transforms
+				merged_instances.emplace_back(run[0], shape_id);
+				removed.insert(run.begin() + 1, run.end());
+				statistics.merged_instances += run.size();
+			}
+
+			for (auto& [instance_index, shape_id] : merged_instances)
+			{
+				movieclip.childrens[instance_index].id = shape_id;
+			}
+
+			remove_instances(movieclip, removed);
+		}
+
+		// Removing source shapes that are not used anymore
+		std::unordered_set<uint16_t> referenced;
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			for (const DisplayObjectInstance& instance : movieclip.childrens)
+			{
+				referenced.insert(instance.id);
+			}
+		}
+
+		for (const ExportName& export_name : swf.exports)
+		{
+			referenced.insert(export_name.id);
+		}
+
+		size_t shapes_count = swf.shapes.size();
+		swf.shapes.erase(
+			std::remove_if(swf.shapes.begin(), swf.shapes.end(),
+				[&source_shapes, &referenced](const Shape& shape)
+				{
+					return source_shapes.count(shape.id) && !referenced.count(shape.id);
+				}
+			),
+			swf.shapes.end()
+		);
+
+		statistics.removed_shapes = shapes_count - swf.shapes.size();
+
+		return statistics.merged_instances > 0;
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "flash/flash.h"
+
+namespace sc::flash
+{
+	struct ShapeBatchingStatistics
+	{
+		size_t merged_instances = 0;
+		size_t created_shapes = 0;
+		size_t removed_shapes = 0;
+	};
+
+	// Merges runs of shape instances that are drawn one after another in every frame of movieclip
+	// and keep exactly the same transforms relative to each other into single shape.
+	// Must be called after atlas finalize, when shape commands have final vertices
+	bool batch_static_shapes(SupercellSWF& swf, ShapeBatchingStatistics& statistics);
+}
@@ -0,0 +1,238 @@
+#include "SpriteHull.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <limits>
+
+namespace sc::Adobe
+{
+	static float cross(const wk::PointF& origin, const wk::PointF& a, const wk::PointF& b)
+	{
+		return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+	}
+
+	// Andrew's monotone chain
+	static void convex_hull(HullPolygon& points, HullPolygon& result)
+	{
+		std::sort(points.begin(), points.end(), [](const wk::PointF& a, const wk::PointF& b)
+			{
+				return a.x < b.x || (a.x == b.x && a.y < b.y);
+			}
+		);
+
+		points.erase(
+			std::unique(points.begin(), points.end(), [](const wk::PointF& a, const wk::PointF& b)
+				{
+					return a.x == b.x && a.y == b.y;
+				}
+			),
+			points.end()
+		);
+
+		result.clear();
+		if (3 > points.size()) return;
+
+		result.resize(points.size() * 2);
+
+		size_t count = 0;
+		for (size_t i = 0; points.size() > i; i++)
+		{
+			while (count >= 2 && 0 >= cross(result[count - 2], result[count - 1], points[i])) count--;
+			result[count++] = points[i];
+		}
+
+		for (size_t i = points.size() - 1, lower = count + 1; i > 0; i--)
+		{
+			while (count >= lower && 0 >= cross(result[count - 2], result[count - 1], points[i - 1])) count--;
+			result[count++] = points[i - 1];
+		}
+
+		result.resize(count - 1);
+	}
+
+	// Removes edge by extending both neighbor edges until they meet.
+	// Polygon only grows, so it still covers everything it covered before
+	static std::optional<wk::PointF> get_edge_collapse_point(const HullPolygon& polygon, size_t index, float& added_area)
+	{
+		size_t count = polygon.size();
+		const wk::PointF& p0 = polygon[(index + count - 1) % count];
+		const wk::PointF& p1 = polygon[index];
+		const wk::PointF& p2 = polygon[(index + 1) % count];
+		const wk::PointF& p3 = polygon[(index + 2) % count];
+
+		wk::PointF d1(p1.x - p0.x, p1.y - p0.y);
+		wk::PointF d2(p2.x - p3.x, p2.y - p3.y);
+
+		float denominator = d1.x * d2.y - d1.y * d2.x;
+		if (std::abs(denominator) < 1e-6f) return std::nullopt;
+
+		float t = ((p3.x - p0.x) * d2.y - (p3.y - p0.y) * d2.x) / denominator;
+		float s = ((p3.x - p0.x) * d1.y - (p3.y - p0.y) * d1.x) / denominator;
+
+		// Intersection must lie in front of both edges
+		if (1.f >= t || 1.f >= s) return std::nullopt;
+
+		wk::PointF intersection(p0.x + d1.x * t, p0.y + d1.y * t);
+		added_area = std::abs(cross(p1, intersection, p2)) / 2.f;
+
+		return intersection;
+	}
+
+	static bool is_inside_image(const wk::RawImage& image, const wk::PointF& point)
+	{
+		return point.x >= 0.f && point.y >= 0.f &&
+			(float)image.width() >= point.x && (float)image.height() >= point.y;
+	}
+
+	static bool is_convex(const HullPolygon& polygon)
+	{
+		bool has_positive = false;
+		bool has_negative = false;
+		for (size_t i = 0; polygon.size() > i; i++)
+		{
+			float value = cross(
+				polygon[i],
+				polygon[(i + 1) % polygon.size()],
+				polygon[(i + 2) % polygon.size()]
+			);
+
+			has_positive |= value > 0;
+			has_negative |= 0 > value;
+		}
+
+		return !(has_positive && has_negative);
+	}
+
+	bool build_sprite_hull(const wk::RawImage& image, uint8_t max_vertices, HullPolygon& result)
+	{
+		if (image.depth() != wk::Image::PixelDepth::RGBA8) return false;
+		if (3 > max_vertices) return false;
+
+		wk::RawImage& pixels = (wk::RawImage&)image;
+
+		// Only first and last visible pixel of each row can be a part of hull
+		HullPolygon points;
+		points.reserve((size_t)image.height() * 4);
+
+		for (uint16_t h = 0; image.height() > h; h++)
+		{
+			int left = -1;
+			int right = -1;
+
+			for (uint16_t w = 0; image.width() > w; w++)
+			{
+				if (!pixels.at<wk::ColorRGBA>(w, h).a) continue;
+
+				if (0 > left) left = w;
+				right = w;
+			}
+
+			if (0 > left) continue;
+
+			points.emplace_back((float)left, (float)h);
+			points.emplace_back((float)left, (float)h + 1);
+			points.emplace_back((float)right + 1, (float)h);
+			points.emplace_back((float)right + 1, (float)h + 1);
+		}
+
+		convex_hull(points, result);
+		if (3 > result.size()) return false;
+
+		// Convex hull is sorted and deduplicated, corners are still used to check final coverage
+		const HullPolygon& corners = points;
+
+		while (result.size() > max_vertices)
+		{
+			std::optional<wk::PointF> best_point;
+			size_t best_index = 0;
+			float best_area = std::numeric_limits<float>::max();
+
+			for (size_t i = 0; result.size() > i; i++)
+			{
+				float area = 0;
+				auto point = get_edge_collapse_point(result, i, area);
+
+				// Vertex outside of image would be clamped later and cut visible pixels
+				if (point.has_value() && !is_inside_image(image, point.value())) continue;
+
+				if (point.has_value() && best_area > area)
+				{
+					best_area = area;
+					best_point = point;
+					best_index = i;
+				}
+			}
+
+			if (!best_point.has_value()) return false;
+
+			size_t next_index = (best_index + 1) % result.size();
+			result[best_index] = best_point.value();
+			result.erase(result.begin() + next_index);
+		}
+
+		// Snap to pixel grid away from polygon center. Vertices are already inside of image bound, so snapped ones stay inside too
+		wk::PointF center(0, 0);
+		for (const wk::PointF& point : result)
+		{
+			center.x += point.x / result.size();
+			center.y += point.y / result.size();
+		}
+
+		for (wk::PointF& point : result)
+		{
+			point.x = point.x > center.x ? std::ceil(point.x) : std::floor(point.x);
+			point.y = point.y > center.y ? std::ceil(point.y) : std::floor(point.y);
+		}
+
+		// Convex polygon that contains corners of every visible row span covers every visible pixel
+		if (!is_convex(result)) return false;
+		for (const wk::PointF& corner : corners)
+		{
+			if (!point_inside_polygon(result, corner)) return false;
+		}
+
+		return true;
+	}
+
+	float polygon_area(const HullPolygon& polygon)
+	{
+		float area = 0;
+		for (size_t i = 0; polygon.size() > i; i++)
+		{
+			const wk::PointF& current = polygon[i];
+			const wk::PointF& next = polygon[(i + 1) % polygon.size()];
+
+			area += current.x * next.y - next.x * current.y;
+		}
+
+		return std::abs(area) / 2.f;
+	}
+
+	bool point_inside_polygon(const HullPolygon& polygon, const wk::PointF& point, float epsilon)
+	{
+		bool inside = false;
+		for (size_t i = 0, j = polygon.size() - 1; polygon.size() > i; j = i++)
+		{
+			const wk::PointF& a = polygon[i];
+			const wk::PointF& b = polygon[j];
+
+			// Points on polygon border are counted as inside
+			float length = std::hypot(b.x - a.x, b.y - a.y);
+			if (length > 0)
+			{
+				float distance = std::abs(cross(a, b, point)) / length;
+				float projection = ((point.x - a.x) * (b.x - a.x) + (point.y - a.y) * (b.y - a.y)) / (length * length);
+				if (epsilon >= distance && projection >= 0 && 1 >= projection) return true;
+			}
+
+			if ((a.y > point.y) != (b.y > point.y) &&
+				point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+			{
+				inside = !inside;
+			}
+		}
+
+		return inside;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "core/math/point.h"
+#include "core/image/raw_image.h"
+
+#include <vector>
+
+namespace sc::Adobe
+{
+	using HullPolygon = std::vector<wk::PointF>;
+
+	// Builds convex polygon around all visible pixels of image with no more than max_vertices points
+	// Points are placed in image pixel coordinates inside of image bound.
+	// Returns false if polygon with such vertices count can't cover every visible pixel
+	bool build_sprite_hull(const wk::RawImage& image, uint8_t max_vertices, HullPolygon& result);
+
+	float polygon_area(const HullPolygon& polygon);
+
+	bool point_inside_polygon(const HullPolygon& polygon, const wk::PointF& point, float epsilon = 0.01f);
+}
@@ -0,0 +1,17 @@
+#include "Transform.h"
+
+namespace sc::flash
+{
+	Matrix2D multiply_matrix(const Matrix2D& parent, const Matrix2D& child)
+	{
+		Matrix2D result;
+		result.a = parent.a * child.a + parent.c * child.b;
+		result.b = parent.b * child.a + parent.d * child.b;
+		result.c = parent.a * child.c + parent.c * child.d;
+		result.d = parent.b * child.c + parent.d * child.d;
+		result.tx = parent.a * child.tx + parent.c * child.ty + parent.tx;
+		result.ty = parent.b * child.tx + parent.d * child.ty + parent.ty;
+
+		return result;
+	}
+}
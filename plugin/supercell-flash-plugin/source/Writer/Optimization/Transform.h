@@ -0,0 +1,12 @@
+#pragma once
+
+#include "flash/flash.h"
+
+namespace sc::flash
+{
+	// Normal blending, instance with it does not change how its content is drawn
+	constexpr uint8_t NormalBlendMode = 0;
+
+	// Result transforms point by child matrix first and then by parent one
+	Matrix2D multiply_matrix(const Matrix2D& parent, const Matrix2D& child);
+}
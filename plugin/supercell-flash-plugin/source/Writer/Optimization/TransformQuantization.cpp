@@ -0,0 +1,70 @@
+#include "TransformQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sc::flash
+{
+	static float quantize_value(float value, double step, float& max_error)
+	{
+		if (step <= 0) return value;
+
+		float result = (float)(std::round(value / step) * step);
+		max_error = std::max(max_error, std::abs(result - value));
+
+		return result;
+	}
+
+	// Grid starts from "identity" value, so identity channels always stay exact
+	static uint8_t quantize_channel(uint8_t value, uint8_t identity, int step, uint8_t& max_error)
+	{
+		if (1 >= step) return value;
+
+		int distance = (int)identity - (int)value;
+		int quantized = std::clamp((int)identity - (int)std::round((double)distance / step) * step, 0, 255);
+
+		max_error = std::max<uint8_t>(max_error, (uint8_t)std::abs(quantized - (int)value));
+
+		return (uint8_t)quantized;
+	}
+
+	void TransformQuantization::quantize(Matrix2D& matrix)
+	{
+		if (!is_matrix_enabled()) return;
+
+		double scale_step = (double)scale_tolerance * 2.0;
+		matrix.a = quantize_value(matrix.a, scale_step, max_scale_error);
+		matrix.b = quantize_value(matrix.b, scale_step, max_scale_error);
+		matrix.c = quantize_value(matrix.c, scale_step, max_scale_error);
+		matrix.d = quantize_value(matrix.d, scale_step, max_scale_error);
+
+		// Translation is stored in pixels
+		double translation_step = (double)translation_tolerance * 2.0 / 20.0;
+		float translation_error = 0;
+		matrix.tx = quantize_value(matrix.tx, translation_step, translation_error);
+		matrix.ty = quantize_value(matrix.ty, translation_step, translation_error);
+		max_translation_error = std::max(max_translation_error, translation_error * 20.f);
+	}
+
+	void TransformQuantization::quantize(ColorTransform& color)
+	{
+		if (!is_color_enabled()) return;
+
+		int step = (int)color_tolerance * 2 + 1;
+		color.multiply.r = quantize_channel(color.multiply.r, 0xFF, step, max_color_error);
+		color.multiply.g = quantize_channel(color.multiply.g, 0xFF, step, max_color_error);
+		color.multiply.b = quantize_channel(color.multiply.b, 0xFF, step, max_color_error);
+		color.alpha = quantize_channel(color.alpha, 0xFF, step, max_color_error);
+
+		color.add.r = quantize_channel(color.add.r, 0, step, max_color_error);
+		color.add.g = quantize_channel(color.add.g, 0, step, max_color_error);
+		color.add.b = quantize_channel(color.add.b, 0, step, max_color_error);
+	}
+
+	void TransformQuantization::merge(const TransformQuantization& other)
+	{
+		max_translation_error = std::max(max_translation_error, other.max_translation_error);
+		max_scale_error = std::max(max_scale_error, other.max_scale_error);
+		max_color_error = std::max(max_color_error, other.max_color_error);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "flash/flash.h"
+
+namespace sc::flash
+{
+	struct TransformQuantization
+	{
+		// Max allowed error of matrix translation in twips
+		float translation_tolerance = 0;
+
+		// Max allowed error of matrix scale, skew and rotation elements
+		float scale_tolerance = 0;
+
+		// Max allowed error of color transform channels
+		uint8_t color_tolerance = 0;
+
+		// Max errors that were actually introduced, translation in twips
+		float max_translation_error = 0;
+		float max_scale_error = 0;
+		uint8_t max_color_error = 0;
+
+		bool is_matrix_enabled() const { return translation_tolerance > 0 || scale_tolerance > 0; }
+		bool is_color_enabled() const { return color_tolerance > 0; }
+
+		// Snaps matrix elements to grid with step of double tolerance,
+		// so all matrices inside one grid cell become equal
+		void quantize(Matrix2D& matrix);
+		void quantize(ColorTransform& color);
+
+		// Keeps the biggest errors from both objects
+		void merge(const TransformQuantization& other);
+	};
+}
@@ -37,54 +37,115 @@ namespace sc::flash
 			}
 		);
 
-		for (uint16_t w = 0; width > w; w++) {
-			for (uint16_t h = 0; height > h; h++) {
-				if (Geometry::point_inside_polygon(polygon, { w, h }) || width == 1 || height == 1)
-				{
-					uint8_t* source = texture->at(w + offset.x, h + offset.y);
-					uint8_t* destination = result->at(w, h);
+		size_t pixel_size = Image::PixelDepthTable[(uint16_t)depth].byte_count;
 
-					Memory::copy(source, destination, Image::PixelDepthTable[(uint16_t)depth].byte_count);
-				}
+		for (uint16_t h = 0; height > h; h++) {
+			int32_t span_begin = 0;
+			int32_t span_end = width - 1;
+
+			if (width != 1 && height != 1 && !get_polygon_span(polygon, h, span_begin, span_end)) continue;
+
+			span_begin = std::max<int32_t>(span_begin, 0);
+			span_end = std::min<int32_t>(span_end, width - 1);
+			if (span_begin > span_end) continue;
+
+			uint8_t* source = texture->at(span_begin + offset.x, h + offset.y);
+			uint8_t* destination = result->at(span_begin, h);
+
+			std::memcpy(destination, source, (size_t)(span_end - span_begin + 1) * pixel_size);
+		}
+	}
+
+	bool get_polygon_span(const std::vector<AtlasGenerator::PointUV>& polygon, uint16_t row, int32_t& begin, int32_t& end)
+	{
+		float min_x = cord_max;
+		float max_x = -cord_max;
+		float y = (float)row;
+
+		for (size_t i = 0; polygon.size() > i; i++)
+		{
+			const AtlasGenerator::PointUV& first = polygon[i];
+			const AtlasGenerator::PointUV& second = polygon[(i + 1) % polygon.size()];
+
+			float y1 = (float)first.y;
+			float y2 = (float)second.y;
+			if (y < std::min(y1, y2) || y > std::max(y1, y2)) continue;
+
+			if (y1 == y2)
+			{
+				min_x = std::min<float>({ min_x, (float)first.x, (float)second.x });
+				max_x = std::max<float>({ max_x, (float)first.x, (float)second.x });
+				continue;
 			}
+
+			float x = (float)first.x + ((y - y1) * ((float)second.x - (float)first.x) / (y2 - y1));
+			min_x = std::min(min_x, x);
+			max_x = std::max(max_x, x);
 		}
+
+		if (min_x > max_x) return false;
+
+		// Pixels on polygon edges are included
+		begin = (int32_t)std::ceil(min_x);
+		end = (int32_t)std::floor(max_x);
+
+		return end >= begin;
 	}
 
 	bool is_solid_9slice(const Shape& shape)
 	{
-		for (uint32_t i = 0; shape.commands.size() > i; i++)
+		if (shape.commands.size() <= 1) return shape.commands.empty();
+
+		const ShapeDrawBitmapCommand& front = shape.commands[0];
+		for (const ShapeDrawBitmapCommand& command : shape.commands)
 		{
-			uint8_t neighbors_count = 0;
-			for (uint32_t t = 0; shape.commands.size() > t; t++)
-			{
-				if (i == t) continue;
+			if (command.texture_index != front.texture_index) return false;
+			if (command.vertices.size() != front.vertices.size()) return false;
+		}
 
-				const ShapeDrawBitmapCommand& first = shape.commands[i];
-				const ShapeDrawBitmapCommand& second = shape.commands[t];
-				bool valid = false;
+		auto get_uv_key = [](const ShapeDrawBitmapCommandVertex& vertex)
+			{
+				uint32_t u = 0;
+				uint32_t v = 0;
+				std::memcpy(&u, &vertex.u, sizeof(u));
+				std::memcpy(&v, &vertex.v, sizeof(v));
 
-				if (shape.commands[i].texture_index != shape.commands[t].texture_index) return false;
-				if (first.vertices.size() != second.vertices.size()) return false;
+				return ((uint64_t)u << 32) | v;
+			};
 
-				for (uint32_t v = 0; first.vertices.size() > v; v++)
+		// UV / Commands that have vertex with this UV
+		std::unordered_map<uint64_t, std::vector<uint32_t>> uv_commands;
+		for (uint32_t i = 0; shape.commands.size() > i; i++)
+		{
+			for (const ShapeDrawBitmapCommandVertex& vertex : shape.commands[i].vertices)
+			{
+				std::vector<uint32_t>& commands = uv_commands[get_uv_key(vertex)];
+				if (commands.empty() || commands.back() != i)
 				{
-					const ShapeDrawBitmapCommandVertex& vertex = first.vertices[v];
-					auto it = std::find_if(
-						second.vertices.begin(), second.vertices.end(),
-						[&vertex](const auto& other)
-						{
-							return other.u == vertex.u && other.v == vertex.v;
-						}
-					);
-
-					valid = it != second.vertices.end();
+					commands.push_back(i);
+				}
+			}
+		}
 
-					if (valid) break;
+		std::vector<uint32_t> neighbors;
+		for (uint32_t i = 0; shape.commands.size() > i; i++)
+		{
+			neighbors.clear();
+			for (const ShapeDrawBitmapCommandVertex& vertex : shape.commands[i].vertices)
+			{
+				for (uint32_t t : uv_commands[get_uv_key(vertex)])
+				{
+					if (t != i && std::find(neighbors.begin(), neighbors.end(), t) == neighbors.end())
+					{
+						neighbors.push_back(t);
+					}
 				}
 
-				if (valid) neighbors_count++;
+				if (neighbors.size() >= 2) break;
 			}
 
+			size_t neighbors_count = neighbors.size();
+
 			// command should has at least 2 neighbor command to be valid
 			// TODO: make it possible to split such neighbors to groups
 			if (2 > neighbors_count)
@@ -143,165 +204,222 @@ namespace sc::flash
 		return result;
 	}
 
-	void repack_atlas(SupercellSWF& swf)
+	void get_bitmap_key(const SWFTexture& texture, const ShapeDrawBitmapCommand& bitmap, BitmapKey& result)
 	{
-		// Id of shapes for nine scaling
-		std::set<uint16_t> nine_scalings_shapes;
+		uint16_t width = texture.image()->width();
+		uint16_t height = texture.image()->height();
+
+		result.clear();
+		result.reserve((bitmap.vertices.size() * 2) + 1);
+		result.push_back(bitmap.texture_index);
 
-		for (MovieClip& movieclip : swf.movieclips)
+		// Sprites are cut by pixel coords, so commands with same coords give the same sprite
+		for (const ShapeDrawBitmapCommandVertex& vertex : bitmap.vertices)
 		{
-			if (!movieclip.scaling_grid.has_value()) continue;
+			result.push_back((uint16_t)std::ceil(vertex.u * width));
+			result.push_back((uint16_t)std::ceil(vertex.v * height));
+		}
+	}
 
-			for (DisplayObjectInstance& children : movieclip.childrens)
-			{
-				DisplayObject& object = swf.GetDisplayObjectByID(children.id);
+	std::size_t BitmapKeyHash::operator()(const BitmapKey& key) const
+	{
+		wk::hash::XxHash code;
+		code.update((const uint8_t*)key.data(), key.size() * sizeof(uint16_t));
 
-				if (object.is_shape() && is_solid_9slice((Shape&)object))
-				{
-					nine_scalings_shapes.insert(object.id);
-				}
+		return code.digest();
+	}
+
+	RawImageRef decode_texture(const SWFTexture& texture)
+	{
+		Ref<RawImage> image = texture.raw_image();
+		Ref<RawImage> result = image;
+
+		switch (image->base_type())
+		{
+		case Image::BasePixelType::RGBA:
+			if (image->depth() != Image::PixelDepth::RGBA8)
+			{
+				result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::RGBA8);
+				RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
+			}
+			break;
+		case Image::BasePixelType::RGB:
+			if (image->depth() != Image::PixelDepth::RGB8)
+			{
+				result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::RGB8);
+				RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
+			}
+			break;
+		case Image::BasePixelType::LA:
+			if (image->depth() != Image::PixelDepth::LUMINANCE8_ALPHA8)
+			{
+				result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::LUMINANCE8_ALPHA8);
+				RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
+			}
+			break;
+		case Image::BasePixelType::L:
+			if (image->depth() != Image::PixelDepth::LUMINANCE8)
+			{
+				result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::LUMINANCE8);
+				RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
 			}
+			break;
+		default:
+			break;
 		}
 
-		// sorted bitmaps to be packed
-		std::vector<ShapeDrawBitmapCommand> bitmaps;
-		bitmaps.reserve((size_t)swf.shapes.size() * 2);
+		return result;
+	}
+
+	void collect_bitmaps(const SupercellSWF& swf, RepackBitmaps& result)
+	{
+		// Shape id / Shape index
+		std::unordered_map<uint16_t, size_t> shape_indices;
+		for (size_t i = 0; swf.shapes.size() > i; i++)
+		{
+			shape_indices[swf.shapes[i].id] = i;
+		}
 
-		// index to bitmap for each bitmap in swf
-		std::vector<size_t> indices;
-		indices.reserve((size_t)swf.shapes.size() * 4);
+		// Same shape can be used by many scaling grid movieclips, so each one is checked only once
+		std::unordered_set<uint16_t> checked_shapes;
 
-		auto get_index = [&bitmaps](const ShapeDrawBitmapCommand& bitmap) -> std::optional<size_t>
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			if (!movieclip.scaling_grid.has_value()) continue;
+
+			for (const DisplayObjectInstance& children : movieclip.childrens)
 			{
-				for (size_t i = 0; bitmaps.size() > i; i++)
+				auto it = shape_indices.find(children.id);
+				if (it == shape_indices.end()) continue;
+				if (!checked_shapes.insert(children.id).second) continue;
+
+				if (is_solid_9slice(swf.shapes[it->second]))
 				{
-					const ShapeDrawBitmapCommand& other = bitmaps[i];
+					result.nine_scalings_shapes.insert(children.id);
+				}
+			}
+		}
 
-					if (bitmap.texture_index != other.texture_index) continue;
-					if (bitmap.vertices.size() != other.vertices.size()) continue;
+		result.bitmaps.reserve((size_t)swf.shapes.size() * 2);
+		result.indices.reserve((size_t)swf.shapes.size() * 4);
 
-					for (uint32_t t = 0; bitmap.vertices.size() > t; t++)
-					{
-						const ShapeDrawBitmapCommandVertex& v1 = bitmap.vertices[t];
-						const ShapeDrawBitmapCommandVertex& v2 = other.vertices[t];
+		// Bitmap key / Index of bitmap
+		std::unordered_map<BitmapKey, size_t, BitmapKeyHash> bitmap_indices;
+		bitmap_indices.reserve(result.bitmaps.capacity());
 
-						if (v1.u != v2.u || v1.v != v2.v)
-						{
-							goto NEXT_BITMAP;
-						}
-					}
-
-					return i;
+		auto push_bitmap = [&swf, &result, &bitmap_indices](const ShapeDrawBitmapCommand& bitmap)
+			{
+				BitmapKey key;
+				get_bitmap_key(swf.textures[bitmap.texture_index], bitmap, key);
+				std::size_t hash = BitmapKeyHash()(key);
 
-				NEXT_BITMAP:
-					continue;
+				auto [it, inserted] = bitmap_indices.try_emplace(std::move(key), result.bitmaps.size());
+				if (inserted)
+				{
+					result.bitmaps.push_back(bitmap);
+					result.hashes.push_back(hash);
 				}
 
-				return std::nullopt;
+				result.indices.push_back(it->second);
 			};
 
 		// Sorting all shapes
-		for (Shape& shape : swf.shapes)
+		for (const Shape& shape : swf.shapes)
 		{
-			auto push_bitmap = [&](ShapeDrawBitmapCommand& bitmap)
-				{
-					auto index = get_index(bitmap);
-
-					if (index.has_value())
-					{
-						indices.push_back(index.value());
-					}
-					else
-					{
-						indices.push_back(bitmaps.size());
-						bitmaps.push_back(bitmap);
-					}
-				};
-
-			if (nine_scalings_shapes.count(shape.id))
+			if (result.nine_scalings_shapes.count(shape.id))
 			{
-				ShapeDrawBitmapCommand proxy = create_proxy_9slice_command(shape);
-				push_bitmap(proxy);
-
-				// Denormalize 9slice commands right there because we need original coords in future
-				for (ShapeDrawBitmapCommand& bitmap : shape.commands)
-				{
-					auto& texture = swf.textures[bitmap.texture_index];
-					for (auto& vertex : bitmap.vertices)
-					{
-						vertex.u = (uint16_t)std::ceil(vertex.u * texture.image()->width());
-						vertex.v = (uint16_t)std::ceil(vertex.v * texture.image()->height());
-					}
-				}
+				push_bitmap(create_proxy_9slice_command(shape));
 			}
 			else
 			{
-				for (ShapeDrawBitmapCommand& bitmap : shape.commands)
+				for (const ShapeDrawBitmapCommand& bitmap : shape.commands)
 				{
 					push_bitmap(bitmap);
 				}
 			};
 		}
 
-		// Decompressing all images to RawImage and converting to raw pixel format
-		std::vector<Ref<RawImage>> images;
-		images.resize(swf.textures.size());
+		result.page_bitmaps.resize(swf.textures.size());
+		for (size_t i = 0; result.bitmaps.size() > i; i++)
+		{
+			result.page_bitmaps[result.bitmaps[i].texture_index].push_back(i);
+		}
+	}
 
-		parallel::enumerate(swf.textures.begin(), swf.textures.end(), [&images](const SWFTexture& texture, size_t n)
-			{
-				Ref<RawImage> image = texture.raw_image();
-				Ref<RawImage> result = image;
+	// Order independent hash of bitmaps on page, empty page has zero hash
+	static std::size_t get_page_hash(const RepackBitmaps& data, size_t page)
+	{
+		const std::vector<size_t>& page_bitmaps = data.page_bitmaps[page];
+		if (page_bitmaps.empty()) return 0;
 
-				switch (image->base_type())
-				{
-				case Image::BasePixelType::RGBA:
-					if (image->depth() != Image::PixelDepth::RGBA8)
-					{
-						result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::RGBA8);
-						RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
-					}
-					break;
-				case Image::BasePixelType::RGB:
-					if (image->depth() != Image::PixelDepth::RGB8)
-					{
-						result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::RGB8);
-						RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
-					}
-					break;
-				case Image::BasePixelType::LA:
-					if (image->depth() != Image::PixelDepth::LUMINANCE8_ALPHA8)
-					{
-						result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::LUMINANCE8_ALPHA8);
-						RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
-					}
-					break;
-				case Image::BasePixelType::L:
-					if (image->depth() != Image::PixelDepth::LUMINANCE8)
-					{
-						result = CreateRef<RawImage>(image->width(), image->height(), Image::PixelDepth::LUMINANCE8);
-						RawImage::remap(image->data(), result->data(), image->width(), image->height(), image->depth(), result->depth());
-					}
-					break;
-				default:
-					break;
-				}
+		std::vector<std::size_t> hashes;
+		hashes.reserve(page_bitmaps.size());
+		for (size_t index : page_bitmaps)
+		{
+			hashes.push_back(data.hashes[index]);
+		}
+		std::sort(hashes.begin(), hashes.end());
 
-				images[n] = result;
-			});
+		wk::hash::XxHash code;
+		code.update((const uint8_t*)hashes.data(), hashes.size() * sizeof(std::size_t));
+
+		return code.digest();
+	}
+
+	void hash_page_bitmaps(const SupercellSWF& swf, std::vector<std::size_t>& result)
+	{
+		RepackBitmaps bitmaps;
+		collect_bitmaps(swf, bitmaps);
+
+		result.resize(bitmaps.page_bitmaps.size());
+		for (size_t i = 0; bitmaps.page_bitmaps.size() > i; i++)
+		{
+			result[i] = get_page_hash(bitmaps, i);
+		}
+	}
+
+	size_t repack_atlas(SupercellSWF& swf, const RepackOptions& options)
+	{
+		RepackBitmaps data;
+		collect_bitmaps(swf, data);
+
+		const std::vector<ShapeDrawBitmapCommand>& bitmaps = data.bitmaps;
+		const std::vector<size_t>& indices = data.indices;
+		const std::set<uint16_t>& nine_scalings_shapes = data.nine_scalings_shapes;
+		const std::vector<std::vector<size_t>>& page_bitmaps = data.page_bitmaps;
+
+		// Pages of loaded file that still use exactly the same sprites are kept as is.
+		// Count alone is not enough, because removed sprite could be replaced by another one from same page
+		std::vector<bool> preserved_pages(swf.textures.size(), false);
+		for (size_t i = 0; swf.textures.size() > i && options.external_page_hashes.size() > i; i++)
+		{
+			preserved_pages[i] = !page_bitmaps[i].empty() && get_page_hash(data, i) == options.external_page_hashes[i];
+		}
+
+		// Size of each page before repack, 9slice commands are placed in pixel coords of original page
+		std::vector<std::pair<uint16_t, uint16_t>> page_sizes;
+		page_sizes.reserve(swf.textures.size());
+		for (const SWFTexture& texture : swf.textures)
+		{
+			page_sizes.emplace_back(texture.image()->width(), texture.image()->height());
+		}
 
 		// Cutting sprites from atlases
 		std::vector<Ref<AtlasGenerator::Item>> items;
 		items.resize(bitmaps.size());
 
+		// Image size of each item for packing strategies
+		std::vector<std::pair<uint32_t, uint32_t>> item_sizes(bitmaps.size(), { 1, 1 });
+
 		std::launch policy = std::launch::deferred;
 #if !WK_DEBUG
 		policy |= std::launch::async;
 #endif // !WK_DEBUG
 
 
-		parallel::enumerate(bitmaps.begin(), bitmaps.end(), [&images, &items](const ShapeDrawBitmapCommand& bitmap, size_t n)
+		auto process_bitmap = [&bitmaps, &items, &item_sizes](RawImageRef texture, size_t n)
 			{
-				auto& texture = images[bitmap.texture_index];
+				const ShapeDrawBitmapCommand& bitmap = bitmaps[n];
 				AtlasGenerator::RectUV bitmap_bound
 				{
 					0xFFFF, 0,
@@ -409,6 +527,7 @@ namespace sc::flash
 						std::set<std::tuple<float, float>> points_set;
 						auto item = CreateRef<AtlasGenerator::Item>(*sprite);
 						items[n] = item;
+						item_sizes[n] = { sprite->width(), sprite->height() };
 
 						item->vertices.reserve(bitmap.vertices.size());
 						for (AtlasGenerator::PointUV& point : points)
@@ -447,36 +566,76 @@ namespace sc::flash
 				{
 					process_sprite();
 				}
+			};
 
-			}, policy
-		);
+		// Only pages that are used by bitmaps of live shapes and are not preserved are decoded.
+		// Pages are processed one by one while next page is decoded in background,
+		// so no more than two decoded pages are kept in memory
+		auto decode_page = [&swf, &page_bitmaps, &preserved_pages, policy](size_t page) -> std::future<RawImageRef>
+			{
+				for (; page_bitmaps.size() > page; page++)
+				{
+					if (page_bitmaps[page].empty() || preserved_pages[page]) continue;
+
+					return std::async(policy, [&swf, page]() { return decode_texture(swf.textures[page]); });
+				}
+
+				return {};
+			};
+
+		std::future<RawImageRef> next_page = decode_page(0);
+		for (size_t page = 0; page_bitmaps.size() > page; page++)
+		{
+			const std::vector<size_t>& page_indices = page_bitmaps[page];
+			if (page_indices.empty() || preserved_pages[page]) continue;
+
+			RawImageRef texture = next_page.get();
+			next_page = decode_page(page + 1);
+
+			parallel::enumerate(page_indices.begin(), page_indices.end(), [&process_bitmap, &texture](size_t bitmap_index, size_t)
+				{
+					process_bitmap(texture, bitmap_index);
+				}, policy
+			);
+		}
 
 		Adobe::SCPlugin& context = Adobe::SCPlugin::Instance();
 		auto* status = context.Window()->CreateStatusBarComponent(
 			context.locale.GetString("TID_STATUS_SPRITE_PACK")
 		);
 
-		AtlasGenerator::Config config(4096, 4096, 1.0f, 2);
+		AtlasPackingSettings settings;
+		settings.max_width = options.max_width;
+		settings.max_height = options.max_height;
+		settings.scale = 1.0f;
+		settings.extrude = 2;
+		settings.strategies = options.packing_strategies;
+
+		// Items of preserved pages are not created
+		std::vector<AtlasPackingItem> packing_items;
+		packing_items.reserve(items.size());
+		for (size_t i = 0; items.size() > i; i++)
+		{
+			if (!items[i]) continue;
+
+			packing_items.push_back({ *items[i], item_sizes[i].first, item_sizes[i].second });
+		}
 
-		int itemCount = (int)items.size();
+		int itemCount = (int)packing_items.size();
 		status->SetRange(itemCount);
 
-		config.progress = [&status](uint32_t value) {
+		settings.progress = [&status](uint32_t value) {
 			status->SetProgress(value);
 			};
 
-		AtlasGenerator::Generator generator(config);
+		AtlasPackingResult packing;
 		size_t atlas_count = 0;
 		try {
-			using AtlasInput = std::reference_wrapper<AtlasGenerator::Item>;
-			AtlasGenerator::Container<AtlasInput> input;
-			input.reserve(items.size());
-			for (auto& item : items)
+			if (!packing_items.empty())
 			{
-				input.emplace_back(*item.get());
+				pack_atlas(packing_items, settings, packing);
+				atlas_count = packing.atlas_count;
 			}
-
-			atlas_count = generator.generate<AtlasInput>(input);
 			context.Window()->DestroyStatusBar(status);
 		}
 		catch (const AtlasGenerator::PackagingException& exception)
@@ -484,16 +643,34 @@ namespace sc::flash
 			throw Exception(exception.what());
 		}
 
-		if (atlas_count >= std::numeric_limits<uint16_t>().max())
+		// Old page index / New page index of preserved pages
+		std::vector<uint16_t> page_remap(swf.textures.size(), 0xFFFF);
+		std::vector<SWFTexture> preserved_textures;
+		for (size_t i = 0; swf.textures.size() > i; i++)
+		{
+			if (!preserved_pages[i]) continue;
+
+			page_remap[i] = (uint16_t)preserved_textures.size();
+			preserved_textures.push_back(std::move(swf.textures[i]));
+		}
+
+		size_t preserved_count = preserved_textures.size();
+		if (preserved_count + atlas_count >= std::numeric_limits<uint16_t>().max())
 		{
 			throw Exception("Failed to repack. Too many textures!");
 		}
 
 		swf.textures.clear();
 
+		// Preserved pages keep their encoded data and go first
+		for (SWFTexture& texture : preserved_textures)
+		{
+			swf.textures.push_back(std::move(texture));
+		}
+
 		for (size_t i = 0; atlas_count > i; i++)
 		{
-			RawImage& atlas = generator.get_atlas(i);
+			RawImage& atlas = packing.generator->get_atlas(i);
 
 			auto& texture = swf.textures.emplace_back();
 			texture.load_from_image(atlas);
@@ -504,16 +681,34 @@ namespace sc::flash
 		{
 			if (nine_scalings_shapes.count(shape.id))
 			{
-				size_t bitmap_index = bitmap_counter++;
-				AtlasGenerator::Item& item = *items[indices[bitmap_index]];
-				auto& texture = swf.textures[item.texture_index];
+				size_t bitmap_index = indices[bitmap_counter++];
+				uint16_t page = bitmaps[bitmap_index].texture_index;
+
+				if (preserved_pages[page])
+				{
+					for (ShapeDrawBitmapCommand& command : shape.commands)
+					{
+						command.texture_index = page_remap[page];
+					}
+
+					continue;
+				}
+
+				AtlasGenerator::Item& item = *items[bitmap_index];
+				uint16_t texture_index = (uint16_t)(item.texture_index + preserved_count);
+				auto& texture = swf.textures[texture_index];
 
 				wk::PointF uv_offset{ cord_max, cord_max };
 
+				// 9slice commands are moved relative to each other in pixel coords of original page
 				for (ShapeDrawBitmapCommand& command : shape.commands)
 				{
+					auto& [page_width, page_height] = page_sizes[command.texture_index];
 					for (auto& vertex : command.vertices)
 					{
+						vertex.u = (uint16_t)std::ceil(vertex.u * page_width);
+						vertex.v = (uint16_t)std::ceil(vertex.v * page_height);
+
 						uv_offset.x = std::min(vertex.u, uv_offset.x);
 						uv_offset.y = std::min(vertex.v, uv_offset.y);
 					}
@@ -521,7 +716,7 @@ namespace sc::flash
 
 				for (ShapeDrawBitmapCommand& command : shape.commands)
 				{
-					command.texture_index = (uint16_t)item.texture_index;
+					command.texture_index = texture_index;
 					for (auto& vertex : command.vertices)
 					{
 						wk::PointF uv_vertex{
@@ -541,8 +736,17 @@ namespace sc::flash
 
 			for (ShapeDrawBitmapCommand& command : shape.commands)
 			{
-				AtlasGenerator::Item& item = *items[indices[bitmap_counter++]];
-				command.texture_index = (uint8_t)item.texture_index;
+				size_t bitmap_index = indices[bitmap_counter++];
+				uint16_t page = bitmaps[bitmap_index].texture_index;
+
+				if (preserved_pages[page])
+				{
+					command.texture_index = page_remap[page];
+					continue;
+				}
+
+				AtlasGenerator::Item& item = *items[bitmap_index];
+				command.texture_index = (uint16_t)(item.texture_index + preserved_count);
 				auto& texture = swf.textures[command.texture_index];
 
 				auto colorfill = item.get_colorfill();
@@ -565,5 +769,7 @@ namespace sc::flash
 				}
 			}
 		}
+
+		return preserved_count;
 	}
 }
\ No newline at end of file
@@ -6,6 +6,13 @@
 #include "flash/flash.h"
 #include "core/geometry/intersect.hpp"
 #include "atlas_generator/Generator.h"
+#include "Writer/Optimization/AtlasPacking.h"
+#include "core/hashing/ncrypto/xxhash.h"
+
+#include <cstring>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace wk;
 namespace sc::flash
@@ -13,9 +20,60 @@ namespace sc::flash
 	constexpr float cord_min = std::numeric_limits<float>::min();
 	constexpr float cord_max = std::numeric_limits<float>::max();
 
+	// Texture index and pixel coords of every vertex
+	using BitmapKey = std::vector<uint16_t>;
+
+	struct BitmapKeyHash
+	{
+		std::size_t operator()(const BitmapKey& key) const;
+	};
+
+	void get_bitmap_key(const SWFTexture& texture, const ShapeDrawBitmapCommand& bitmap, BitmapKey& result);
+
 	void get_sprite(RawImageRef& texture, AtlasGenerator::RectUV bound, const std::vector<AtlasGenerator::PointUV>& points, RawImageRef& result);
+
+	// Decodes texture and converts it to 8 bit per channel pixel format
+	RawImageRef decode_texture(const SWFTexture& texture);
+
+	// Range of pixels inside of convex polygon on image row
+	bool get_polygon_span(const std::vector<AtlasGenerator::PointUV>& polygon, uint16_t row, int32_t& begin, int32_t& end);
 	bool is_solid_9slice(const Shape& shape);
 	ShapeDrawBitmapCommand create_proxy_9slice_command(const Shape& shape);
 
-	void repack_atlas(SupercellSWF& swf);
+	struct RepackBitmaps
+	{
+		// Id of shapes for nine scaling
+		std::set<uint16_t> nine_scalings_shapes;
+
+		// Unique bitmaps to be packed
+		std::vector<ShapeDrawBitmapCommand> bitmaps;
+
+		// Index of bitmap for each command of shapes in order, 9slice shapes have single proxy bitmap
+		std::vector<size_t> indices;
+
+		// Indices of bitmaps placed on each texture page
+		std::vector<std::vector<size_t>> page_bitmaps;
+
+		// Hash of bitmap key for each unique bitmap
+		std::vector<std::size_t> hashes;
+	};
+
+	struct RepackOptions
+	{
+		// Hash of unique bitmaps on each page of loaded file.
+		// Pages that still use exactly the same bitmaps are kept as is, empty vector repacks everything
+		std::vector<std::size_t> external_page_hashes;
+
+		// Limits of repacked pages
+		uint32_t max_width = 4096;
+		uint32_t max_height = 4096;
+
+		uint8_t packing_strategies = 1;
+	};
+
+	void collect_bitmaps(const SupercellSWF& swf, RepackBitmaps& result);
+	void hash_page_bitmaps(const SupercellSWF& swf, std::vector<std::size_t>& result);
+
+	// Returns count of preserved pages, they are placed before repacked ones
+	size_t repack_atlas(SupercellSWF& swf, const RepackOptions& options);
 }
\ No newline at end of file
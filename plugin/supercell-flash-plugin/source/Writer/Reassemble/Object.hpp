@@ -4,51 +4,20 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 namespace sc::flash
 {
-	using ReferenceMap = std::map<uint16_t, uint32_t>;
 	using IdMap = std::map<uint16_t, uint16_t>;
 
-	static void get_object_references(SupercellSWF& swf, ReferenceMap& object_references, uint16_t id)
+	struct RemoveUnusedStatistics
 	{
-		auto add_reference = [&object_references](uint16_t id)
-			{
-				if (!object_references.count(id))
-				{
-					object_references[id] = 1;
-				}
-				else
-				{
-					object_references[id] += 1;
-				}
-			};
-
-		std::function<void(uint16_t)> process_display_object = [&swf, &add_reference, &process_display_object](uint16_t id)
-			{
-				add_reference(id);
-
-				DisplayObject& object = swf.GetDisplayObjectByID(id);
-				if (object.is_movieclip())
-				{
-					MovieClip& movieclip = (MovieClip&)object;
-					for (DisplayObjectInstance instance : movieclip.childrens)
-					{
-						process_display_object(instance.id);
-					}
-				}
-			};
-
-		DisplayObject& object = swf.GetDisplayObjectByID(id);
-		add_reference(id);
-		if (object.is_movieclip())
-		{
-			for (DisplayObjectInstance& instance : ((MovieClip&)object).childrens)
-			{
-				process_display_object(instance.id);
-			}
-		}
-	}
+		size_t objects = 0;
+		size_t textures = 0;
+		size_t matrices = 0;
+		size_t color_transforms = 0;
+		size_t banks = 0;
+	};
 
 	static void erase_objects_if(SupercellSWF& swf, std::function<bool(const DisplayObject&)> condition)
 	{
@@ -73,22 +42,290 @@ namespace sc::flash
 		);
 	}
 
-	static void remove_unused(SupercellSWF& swf)
+	// Moves kept elements to the front in original order and erases the rest.
+	// Returns new index of each element or 0xFFFF for removed ones
+	template<typename T>
+	static std::vector<uint16_t> compact_by_usage(T& container, const std::vector<bool>& used)
 	{
-		ReferenceMap object_references;
+		std::vector<uint16_t> remap(container.size(), 0xFFFF);
+
+		size_t write_index = 0;
+		for (size_t i = 0; container.size() > i; i++)
+		{
+			if (!used[i]) continue;
+
+			if (write_index != i)
+			{
+				container[write_index] = std::move(container[i]);
+			}
+			remap[i] = (uint16_t)write_index++;
+		}
+
+		container.erase(container.begin() + write_index, container.end());
+		return remap;
+	}
+
+	// Removes display objects that can't be reached from exports
+	static void remove_unused(SupercellSWF& swf, RemoveUnusedStatistics& statistics)
+	{
+		// Only movieclips have childrens, so other objects are leaves of the graph
+		std::vector<MovieClip*> movieclips(0x10000, nullptr);
+		for (MovieClip& movieclip : swf.movieclips)
+		{
+			movieclips[movieclip.id] = &movieclip;
+		}
+
+		// Every object is visited once, even if it is shared by many exports
+		std::vector<bool> visited(0x10000, false);
+		std::vector<uint16_t> stack;
+
+		auto visit = [&visited, &stack](uint16_t id)
+			{
+				if (visited[id]) return;
+
+				visited[id] = true;
+				stack.push_back(id);
+			};
+
+		for (ExportName& export_name : swf.exports)
+		{
+			visit(export_name.id);
+		}
+
+		while (!stack.empty())
+		{
+			uint16_t id = stack.back();
+			stack.pop_back();
+
+			MovieClip* movieclip = movieclips[id];
+			if (movieclip == nullptr) continue;
+
+			for (const DisplayObjectInstance& instance : movieclip->childrens)
+			{
+				visit(instance.id);
+			}
+		}
+
+		size_t objects_count = swf.movieclips.size() + swf.shapes.size() + swf.movieclip_modifiers.size() + swf.textfields.size();
+
+		erase_objects_if(swf, [&visited](const DisplayObject& object)
+			{
+				return !visited[object.id];
+			}
+		);
+
+		statistics.objects = objects_count - (swf.movieclips.size() + swf.shapes.size() + swf.movieclip_modifiers.size() + swf.textfields.size());
+	}
+
+	// Renumbers display objects densely keeping order of their current ids.
+	// Instances and exports are rewritten to new ids, so exports still point to the same objects by name.
+	// Exports of missing objects are removed, instances of missing objects are treated as error.
+	// Returns count of ids that were changed
+	static size_t compact_object_ids(SupercellSWF& swf)
+	{
+		std::vector<bool> used(0x10000, false);
+		auto mark = [&used](const DisplayObject& object)
+			{
+				used[object.id] = true;
+			};
+
+		for (const MovieClip& object : swf.movieclips) mark(object);
+		for (const Shape& object : swf.shapes) mark(object);
+		for (const MovieClipModifier& object : swf.movieclip_modifiers) mark(object);
+		for (const TextField& object : swf.textfields) mark(object);
+
+		std::vector<uint16_t> remap(0x10000, 0xFFFF);
+		size_t changed = 0;
+
+		uint16_t next_id = 0;
+		for (uint32_t id = 0; used.size() > id; id++)
+		{
+			if (!used[id]) continue;
+
+			if (next_id != id) changed++;
+			remap[id] = next_id++;
+		}
+
+		if (changed == 0) return 0;
+
+		// Old id of missing object could match new id of another one, so dangling references can't be kept as is
+		for (const MovieClip& object : swf.movieclips)
+		{
+			for (const DisplayObjectInstance& instance : object.childrens)
+			{
+				if (!used[instance.id])
+				{
+					throw wk::Exception("Failed to compact object ids. Movieclip has instance of missing object");
+				}
+			}
+		}
+
+		swf.exports.erase(
+			std::remove_if(swf.exports.begin(), swf.exports.end(), [&used](const ExportName& export_name)
+				{
+					return !used[export_name.id];
+				}
+			),
+			swf.exports.end()
+		);
 
-		auto is_object_has_reference = [&object_references](const DisplayObject& object)
+		auto apply = [&remap](DisplayObject& object)
 			{
-				return !object_references.count(object.id);
+				object.id = remap[object.id];
 			};
 
-		// Collecting object references count
+		for (MovieClip& object : swf.movieclips)
+		{
+			apply(object);
+
+			for (DisplayObjectInstance& instance : object.childrens)
+			{
+				instance.id = remap[instance.id];
+			}
+		}
+
+		for (Shape& object : swf.shapes) apply(object);
+		for (MovieClipModifier& object : swf.movieclip_modifiers) apply(object);
+		for (TextField& object : swf.textfields) apply(object);
+
 		for (ExportName& export_name : swf.exports)
 		{
-			get_object_references(swf, object_references, export_name.id);
+			export_name.id = remap[export_name.id];
+		}
+
+		return changed;
+	}
+
+	// Removes textures that are not used by any shape command and matrix bank entries
+	// that are not used by any frame element. Must be called after shapes get their final commands
+	static void remove_unused_resources(SupercellSWF& swf, RemoveUnusedStatistics& statistics)
+	{
+		// Indices are checked before anything is changed, because after compaction
+		// out of range index would point to another texture or transform
+		for (const Shape& shape : swf.shapes)
+		{
+			for (const ShapeDrawBitmapCommand& command : shape.commands)
+			{
+				if (command.texture_index >= swf.textures.size())
+				{
+					throw wk::Exception("Failed to remove unused resources. Shape uses texture out of range");
+				}
+			}
+		}
+
+		for (const MovieClip& movieclip : swf.movieclips)
+		{
+			if (movieclip.bank_index >= swf.matrixBanks.size())
+			{
+				throw wk::Exception("Failed to remove unused resources. Movieclip uses matrix bank out of range");
+			}
+
+			const MatrixBank& bank = swf.matrixBanks[movieclip.bank_index];
+			for (const MovieClipFrameElement& element : movieclip.frame_elements)
+			{
+				if ((element.matrix_index != 0xFFFF && element.matrix_index >= bank.matrices.size()) ||
+					(element.colorTransform_index != 0xFFFF && element.colorTransform_index >= bank.color_transforms.size()))
+				{
+					throw wk::Exception("Failed to remove unused resources. Movieclip uses transform out of range");
+				}
+			}
 		}
 
-		// Erasing unused objects
-		erase_objects_if(swf, is_object_has_reference);
+		// Textures
+		{
+			std::vector<bool> used(swf.textures.size(), false);
+			for (const Shape& shape : swf.shapes)
+			{
+				for (const ShapeDrawBitmapCommand& command : shape.commands)
+				{
+					used[command.texture_index] = true;
+				}
+			}
+
+			size_t textures_count = swf.textures.size();
+			std::vector<uint16_t> remap = compact_by_usage(swf.textures, used);
+
+			if (textures_count != swf.textures.size())
+			{
+				for (Shape& shape : swf.shapes)
+				{
+					for (ShapeDrawBitmapCommand& command : shape.commands)
+					{
+						command.texture_index = remap[command.texture_index];
+					}
+				}
+			}
+
+			statistics.textures = textures_count - swf.textures.size();
+		}
+
+		// Matrix banks
+		if (!swf.matrixBanks.empty())
+		{
+			std::vector<bool> used_banks(swf.matrixBanks.size(), false);
+			std::vector<std::vector<bool>> used_matrices(swf.matrixBanks.size());
+			std::vector<std::vector<bool>> used_colors(swf.matrixBanks.size());
+
+			for (size_t i = 0; swf.matrixBanks.size() > i; i++)
+			{
+				used_matrices[i].resize(swf.matrixBanks[i].matrices.size(), false);
+				used_colors[i].resize(swf.matrixBanks[i].color_transforms.size(), false);
+			}
+
+			// First bank is default one, so it is always kept
+			used_banks[0] = true;
+
+			for (const MovieClip& movieclip : swf.movieclips)
+			{
+				used_banks[movieclip.bank_index] = true;
+
+				std::vector<bool>& matrices = used_matrices[movieclip.bank_index];
+				std::vector<bool>& colors = used_colors[movieclip.bank_index];
+
+				for (const MovieClipFrameElement& element : movieclip.frame_elements)
+				{
+					if (element.matrix_index != 0xFFFF) matrices[element.matrix_index] = true;
+					if (element.colorTransform_index != 0xFFFF) colors[element.colorTransform_index] = true;
+				}
+			}
+
+			std::vector<std::vector<uint16_t>> matrix_remap(swf.matrixBanks.size());
+			std::vector<std::vector<uint16_t>> color_remap(swf.matrixBanks.size());
+			for (size_t i = 0; swf.matrixBanks.size() > i; i++)
+			{
+				MatrixBank& bank = swf.matrixBanks[i];
+
+				size_t matrices_count = bank.matrices.size();
+				size_t colors_count = bank.color_transforms.size();
+
+				matrix_remap[i] = compact_by_usage(bank.matrices, used_matrices[i]);
+				color_remap[i] = compact_by_usage(bank.color_transforms, used_colors[i]);
+
+				statistics.matrices += matrices_count - bank.matrices.size();
+				statistics.color_transforms += colors_count - bank.color_transforms.size();
+			}
+
+			for (MovieClip& movieclip : swf.movieclips)
+			{
+				const std::vector<uint16_t>& matrices = matrix_remap[movieclip.bank_index];
+				const std::vector<uint16_t>& colors = color_remap[movieclip.bank_index];
+
+				for (MovieClipFrameElement& element : movieclip.frame_elements)
+				{
+					if (element.matrix_index != 0xFFFF) element.matrix_index = matrices[element.matrix_index];
+					if (element.colorTransform_index != 0xFFFF) element.colorTransform_index = colors[element.colorTransform_index];
+				}
+			}
+
+			size_t banks_count = swf.matrixBanks.size();
+			std::vector<uint16_t> bank_remap = compact_by_usage(swf.matrixBanks, used_banks);
+
+			for (MovieClip& movieclip : swf.movieclips)
+			{
+				movieclip.bank_index = bank_remap[movieclip.bank_index];
+			}
+
+			statistics.banks = banks_count - swf.matrixBanks.size();
+		}
 	}
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 #include "Module/Module.h"
 
 #include <CDT.h>
+#include <cstring>
 
 #include "core/hashing/ncrypto/xxhash.h"
 #include "core/hashing/hash.h"
@@ -23,9 +24,170 @@ namespace sc {
 		}
 
 		void SCShapeWriter::AddGraphic(const Animate::Publisher::BitmapElement& item) {
-			wk::RawImageRef image = m_writer.GetBitmap(item);
+			std::size_t image_hash = 0;
+			wk::RawImageRef image = m_writer.GetBitmap(item, image_hash);
 
-			m_group.AddElement<BitmapItem>(m_symbol, image, item.Transformation());
+			AddBitmapItem(image, item.Transformation(), false, image_hash);
+		}
+
+		void SCShapeWriter::AddBitmapItem(
+			wk::RawImageRef image,
+			const Animate::DOM::Utils::MATRIX2D& matrix,
+			bool rasterized,
+			std::optional<std::size_t> image_hash
+		)
+		{
+			wk::ColorRGBA color;
+			wk::RectF bound;
+
+			// Rasterized sprites already has premultiplied alpha
+			if (!IsUniformColorImage(*image, rasterized, color, bound))
+			{
+				m_group.AddElement<BitmapItem>(m_symbol, image, matrix, rasterized, image_hash);
+				return;
+			}
+
+			std::vector<Point2D> points = {
+				{bound.left, bound.top},
+				{bound.right, bound.top},
+				{bound.right, bound.bottom},
+				{bound.left, bound.bottom}
+			};
+
+			std::vector<FilledItemContour> contour = { FilledItemContour(points) };
+			m_group.AddElement<FilledItem>(m_symbol, contour, color, matrix);
+		}
+
+		bool SCShapeWriter::IsUniformColorImage(const wk::RawImage& image, bool premultiplied, wk::ColorRGBA& color, wk::RectF& bound)
+		{
+			// Max channel difference between pixels that still counts as same color
+			const int tolerance = 2;
+
+			bool has_alpha = image.depth() == wk::Image::PixelDepth::RGBA8;
+			if (!has_alpha && image.depth() != wk::Image::PixelDepth::RGB8) return false;
+			if (image.width() == 0 || image.height() == 0) return false;
+
+			auto pixel_at = [&image, has_alpha](uint16_t x, uint16_t y) -> wk::ColorRGBA
+				{
+					if (has_alpha)
+					{
+						return ((wk::RawImage&)image).at<wk::ColorRGBA>(x, y);
+					}
+
+					const wk::ColorRGB& pixel = ((wk::RawImage&)image).at<wk::ColorRGB>(x, y);
+					return wk::ColorRGBA(pixel.r, pixel.g, pixel.b, 0xFF);
+				};
+
+			// Bounding box of visible pixels
+			int left = image.width(), right = -1;
+			int top = image.height(), bottom = -1;
+			for (uint16_t h = 0; image.height() > h; h++)
+			{
+				for (uint16_t w = 0; image.width() > w; w++)
+				{
+					if (!pixel_at(w, h).a) continue;
+
+					left = std::min<int>(left, w);
+					right = std::max<int>(right, w);
+					top = std::min<int>(top, h);
+					bottom = std::max<int>(bottom, h);
+				}
+			}
+
+			// Image is fully transparent or too small to have inner area
+			if (0 > right || 3 > right - left || 3 > bottom - top) return false;
+
+			const wk::ColorRGBA reference = pixel_at((left + right) / 2, (top + bottom) / 2);
+			if (!reference.a) return false;
+
+			auto is_same_color = [&](const wk::ColorRGBA& pixel) -> bool
+				{
+					if (std::abs((int)pixel.a - (int)reference.a) > tolerance) return false;
+
+					return std::abs((int)pixel.r - (int)reference.r) <= tolerance &&
+						std::abs((int)pixel.g - (int)reference.g) <= tolerance &&
+						std::abs((int)pixel.b - (int)reference.b) <= tolerance;
+				};
+
+			// Checks that pixel is just a less covered version of reference color
+			auto is_edge_color = [&](const wk::ColorRGBA& pixel) -> bool
+				{
+					if (pixel.a > reference.a + tolerance) return false;
+
+					float factor = premultiplied ? (float)pixel.a / (float)reference.a : 1.f;
+					return std::abs(pixel.r - reference.r * factor) <= tolerance &&
+						std::abs(pixel.g - reference.g * factor) <= tolerance &&
+						std::abs(pixel.b - reference.b * factor) <= tolerance;
+				};
+
+			// Each border line of bounding box may be antialiased edge
+			// Such line must have same coverage along the whole length
+			auto get_edge_coverage = [&](bool horizontal, int position, int begin, int end, float& coverage) -> bool
+				{
+					wk::ColorRGBA middle = horizontal ? pixel_at((begin + end) / 2, position) : pixel_at(position, (begin + end) / 2);
+					if (is_same_color(middle))
+					{
+						coverage = 1.f;
+						return true;
+					}
+
+					for (int i = begin; end >= i; i++)
+					{
+						wk::ColorRGBA pixel = horizontal ? pixel_at(i, position) : pixel_at(position, i);
+						if (std::abs((int)pixel.a - (int)middle.a) > tolerance || !is_edge_color(pixel)) return false;
+					}
+
+					coverage = (float)middle.a / (float)reference.a;
+					return true;
+				};
+
+			float top_coverage = 1.f, bottom_coverage = 1.f, left_coverage = 1.f, right_coverage = 1.f;
+			if (!get_edge_coverage(true, top, left + 1, right - 1, top_coverage)) return false;
+			if (!get_edge_coverage(true, bottom, left + 1, right - 1, bottom_coverage)) return false;
+			if (!get_edge_coverage(false, left, top + 1, bottom - 1, left_coverage)) return false;
+			if (!get_edge_coverage(false, right, top + 1, bottom - 1, right_coverage)) return false;
+
+			// Inner area without antialiased edges
+			int inner_left = left + (left_coverage < 1.f ? 1 : 0);
+			int inner_right = right - (right_coverage < 1.f ? 1 : 0);
+			int inner_top = top + (top_coverage < 1.f ? 1 : 0);
+			int inner_bottom = bottom - (bottom_coverage < 1.f ? 1 : 0);
+
+			for (int h = top; bottom >= h; h++)
+			{
+				for (int w = left; right >= w; w++)
+				{
+					bool inner_x = w >= inner_left && inner_right >= w;
+					bool inner_y = h >= inner_top && inner_bottom >= h;
+					wk::ColorRGBA pixel = pixel_at(w, h);
+
+					if (inner_x && inner_y)
+					{
+						if (!is_same_color(pixel)) return false;
+					}
+					// Corners and edges
+					else
+					{
+						if (pixel.a && !is_edge_color(pixel)) return false;
+					}
+				}
+			}
+
+			bound.left = inner_left - (left_coverage < 1.f ? left_coverage : 0.f);
+			bound.right = inner_right + 1 + (right_coverage < 1.f ? right_coverage : 0.f);
+			bound.top = inner_top - (top_coverage < 1.f ? top_coverage : 0.f);
+			bound.bottom = inner_bottom + 1 + (bottom_coverage < 1.f ? bottom_coverage : 0.f);
+
+			color = reference;
+			if (premultiplied)
+			{
+				float alpha = (float)reference.a / 255.f;
+				color.r = (uint8_t)std::clamp(std::round(reference.r / alpha), 0.f, 255.f);
+				color.g = (uint8_t)std::clamp(std::round(reference.g / alpha), 0.f, 255.f);
+				color.b = (uint8_t)std::clamp(std::round(reference.b / alpha), 0.f, 255.f);
+			}
+
+			return true;
 		}
 
 		void SCShapeWriter::AddFilledElement(const Animate::Publisher::FilledElement& shape) {
@@ -121,6 +283,14 @@ namespace sc {
 			float resolution
 		)
 		{
+			// Bitmap fill patterns are positioned by whole canvas, so only solid fills can be split to tiles
+			if (region.type == FilledElementRegion::ShapeType::SolidColor &&
+				SCShapeWriter::IsSparseRasterizationBound(region.Bound(), resolution))
+			{
+				AddTiledRasterizedRegion(region, matrix, resolution);
+				return;
+			}
+
 			wk::RawImageRef sprite;
 			wk::Point offset;
 			DrawRegion(region, resolution, sprite, offset);
@@ -134,7 +304,189 @@ namespace sc {
 				std::round(offset.y * matrix.d + offset.x * matrix.b + matrix.ty)
 			};
 
-			m_group.AddElement<BitmapItem>(m_symbol, sprite, transform, true);
+			AddBitmapItem(sprite, transform, true);
+		}
+
+		void SCShapeWriter::AddTiledRasterizedRegion(
+			const FilledElementRegion& region,
+			const Animate::DOM::Utils::MATRIX2D& matrix,
+			float resolution
+		)
+		{
+			struct Tile
+			{
+				wk::RawImageRef image;
+				wk::Point position;
+			};
+
+			const uint16_t tile_size = SCShapeWriter::RasterizationTileSize;
+
+			Animate::DOM::Utils::RECT bound = region.Bound();
+			wk::PointF draw_offset(-std::min(bound.topLeft.x, bound.bottomRight.x), -std::min(bound.topLeft.y, bound.bottomRight.y));
+			wk::Point region_offset(bound.bottomRight.x, bound.bottomRight.y);
+
+			SCShapeWriter::RoundDomRectangle(bound);
+			uint32_t width = (uint32_t)(std::ceil(bound.topLeft.x - bound.bottomRight.x) * resolution);
+			uint32_t height = (uint32_t)(std::ceil(bound.topLeft.y - bound.bottomRight.y) * resolution);
+
+			// Separate tiles are overlapped by 1px so texture filtering does not show seams between them.
+			// Overlapped pixels are drawn twice, so it is only done for opaque fills
+			const auto& fill = std::get<FilledElementRegion::SolidFill>(region.style);
+			const int padding = fill.color.alpha == 0xFF ? 1 : 0;
+			const uint16_t canvas_size = tile_size + padding * 2;
+
+			// Only one tile sized canvas is allocated and reused for every tile
+			CreateCanvas(canvas_size, canvas_size);
+			bl_assert(canvas->ctx.end());
+
+			std::vector<Tile> tiles;
+			wk::Point coverage_min(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+			wk::Point coverage_max(0, 0);
+			uint64_t tiles_area = 0;
+
+			for (uint32_t y = 0; height > y; y += tile_size)
+			{
+				for (uint32_t x = 0; width > x; x += tile_size)
+				{
+					uint16_t tile_width = (uint16_t)std::min<uint32_t>(tile_size, width - x) + padding * 2;
+					uint16_t tile_height = (uint16_t)std::min<uint32_t>(tile_size, height - y) + padding * 2;
+
+					std::memset(canvas->image->data(), 0, canvas->image->pixel_size() * canvas_size * canvas_size);
+					canvas->ctx = BLContext(canvas->canvas_image);
+
+					DrawRegion(
+						region,
+						wk::PointF(
+							draw_offset.x - ((float)x - padding) / resolution,
+							draw_offset.y - ((float)y - padding) / resolution
+						),
+						resolution
+					);
+					bl_assert(canvas->ctx.end());
+
+					Tile tile;
+					wk::Point crop_offset;
+					if (!SCShapeWriter::CropImage(*canvas->image, tile_width, tile_height, tile.image, crop_offset)) continue;
+
+					tile.position = wk::Point((int)x - padding + crop_offset.x, (int)y - padding + crop_offset.y);
+					tiles_area += (uint64_t)tile.image->width() * tile.image->height();
+
+					coverage_min.x = std::min<int>(coverage_min.x, tile.position.x);
+					coverage_min.y = std::min<int>(coverage_min.y, tile.position.y);
+					coverage_max.x = std::max<int>(coverage_max.x, tile.position.x + tile.image->width());
+					coverage_max.y = std::max<int>(coverage_max.y, tile.position.y + tile.image->height());
+
+					tiles.push_back(tile);
+				}
+			}
+
+			canvas.reset();
+
+			if (tiles.empty()) return;
+
+			// Tiles are only worth it when visible pixels cover small part of their bound.
+			// Otherwise all tiles are joined to one sprite cropped by coverage bound
+			uint64_t coverage_area = (uint64_t)(coverage_max.x - coverage_min.x) * (coverage_max.y - coverage_min.y);
+			if (tiles.size() > 1 && tiles_area * SCShapeWriter::SparseRasterizationRatio > coverage_area)
+			{
+				wk::RawImageRef sprite = wk::CreateRef<wk::RawImage>(
+					coverage_max.x - coverage_min.x,
+					coverage_max.y - coverage_min.y,
+					wk::Image::PixelDepth::RGBA8,
+					wk::Image::ColorSpace::Linear
+				);
+				std::memset(sprite->data(), 0, sprite->pixel_size() * sprite->width() * sprite->height());
+
+				for (const Tile& tile : tiles)
+				{
+					for (uint16_t h = 0; tile.image->height() > h; h++)
+					{
+						std::memcpy(
+							sprite->at(tile.position.x - coverage_min.x, tile.position.y - coverage_min.y + h),
+							tile.image->at(0, h),
+							tile.image->pixel_size() * tile.image->width()
+						);
+					}
+				}
+
+				tiles.clear();
+				tiles.push_back({ sprite, coverage_min });
+			}
+
+			// Only region origin is rounded. Tiles are placed from it with exact offsets,
+			// so neighbour tiles keep their relative position under fractional scale or rotation
+			wk::PointF origin(
+				std::round(region_offset.x * matrix.a + region_offset.y * matrix.c + matrix.tx),
+				std::round(region_offset.y * matrix.d + region_offset.x * matrix.b + matrix.ty)
+			);
+
+			for (const Tile& tile : tiles)
+			{
+				wk::PointF offset(
+					tile.position.x / resolution,
+					tile.position.y / resolution
+				);
+
+				const Animate::DOM::Utils::MATRIX2D transform = {
+					matrix.a * (1.f / resolution),
+					matrix.b,
+					matrix.c,
+					matrix.d * (1.f / resolution),
+					origin.x + offset.x * matrix.a + offset.y * matrix.c,
+					origin.y + offset.y * matrix.d + offset.x * matrix.b
+				};
+
+				AddBitmapItem(tile.image, transform, true);
+			}
+		}
+
+		bool SCShapeWriter::IsSparseRasterizationBound(const Animate::DOM::Utils::RECT& bound, float resolution)
+		{
+			float width = std::abs(bound.topLeft.x - bound.bottomRight.x) * resolution;
+			float height = std::abs(bound.topLeft.y - bound.bottomRight.y) * resolution;
+
+			return width * height > SCShapeWriter::SparseRasterizationArea;
+		}
+
+		bool SCShapeWriter::CropImage(const wk::RawImage& image, uint16_t width, uint16_t height, wk::RawImageRef& result, wk::Point& offset)
+		{
+			wk::RawImage& source = (wk::RawImage&)image;
+
+			int left = width, right = -1;
+			int top = height, bottom = -1;
+			for (uint16_t h = 0; height > h; h++)
+			{
+				for (uint16_t w = 0; width > w; w++)
+				{
+					if (!source.at<wk::ColorRGBA>(w, h).a) continue;
+
+					left = std::min<int>(left, w);
+					right = std::max<int>(right, w);
+					top = std::min<int>(top, h);
+					bottom = std::max<int>(bottom, h);
+				}
+			}
+
+			if (0 > right) return false;
+
+			offset = wk::Point(left, top);
+			result = wk::CreateRef<wk::RawImage>(
+				right - left + 1,
+				bottom - top + 1,
+				wk::Image::PixelDepth::RGBA8,
+				wk::Image::ColorSpace::Linear
+			);
+
+			for (uint16_t h = 0; result->height() > h; h++)
+			{
+				std::memcpy(
+					result->at(0, h),
+					source.at(left, top + h),
+					result->pixel_size() * result->width()
+				);
+			}
+
+			return true;
 		}
 
 		void SCShapeWriter::CreatePath(
@@ -335,69 +687,77 @@ namespace sc {
 				{guides.bottomRight.x * resolution, guides.bottomRight.y * resolution}
 			};
 
-			Animate::DOM::Utils::RECT bound{
-				{std::numeric_limits<float>::min(),
-				std::numeric_limits<float>::min()},
-				{std::numeric_limits<float>::max(),
-				std::numeric_limits<float>::max()}
-			};
+			// Then calculate bound of all elements in scaled symbol space
+			// Elements itself are not copied, their transform is applied by canvas during drawing
+			wk::PointF bound_min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+			wk::PointF bound_max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
 
-			// Then create copy of elements
-			// And make their points bigger
-			std::vector<FilledElement> transformed_elements;
 			const auto& elements = slice.Elements();
 			for (size_t i = 0; elements.Size() > i; i++)
 			{
 				StaticElement& element = elements[i];
 				if (!element.IsFilledArea()) continue;
 
-				FilledElement& transformed_element = transformed_elements.emplace_back((const FilledElement&)element);
-				transformed_element.Transform(
-					element.Transformation()
-				);
+				const Animate::DOM::Utils::MATRIX2D& matrix = element.Transformation();
+				Animate::DOM::Utils::RECT bound = ((const FilledElement&)element).Bound();
 
-				transformed_element.Transform(
+				for (float x : { bound.topLeft.x, bound.bottomRight.x })
+				{
+					for (float y : { bound.topLeft.y, bound.bottomRight.y })
 					{
-						resolution,
-						0.0f,
-						0.0f,
-						resolution,
-						0.0f,
-						0.0f
-					}
-				);
+						float point_x = (matrix.a * x + matrix.c * y + matrix.tx) * resolution;
+						float point_y = (matrix.b * x + matrix.d * y + matrix.ty) * resolution;
 
-				bound = bound + transformed_element.Bound();
-
-				//for (auto& region : transformed_element.fill)
-				//{
-				//	SCShapeWriter::RoundRegion(region);
-				//}
-				//
-				//for (auto& region : transformed_element.stroke)
-				//{
-				//	SCShapeWriter::RoundRegion(region);
-				//}
+						bound_min.x = std::min(bound_min.x, point_x);
+						bound_min.y = std::min(bound_min.y, point_y);
+						bound_max.x = std::max(bound_max.x, point_x);
+						bound_max.y = std::max(bound_max.y, point_y);
+					}
+				}
 			}
 
-			wk::Point offset(bound.bottomRight.x, bound.bottomRight.y);
-			SCShapeWriter::RoundDomRectangle(bound);
-			wk::RawImageRef sprite = wk::CreateRef<wk::RawImage>(
-				std::ceil(bound.topLeft.x - offset.x),
-				std::ceil(bound.topLeft.y - offset.y),
-				wk::Image::PixelDepth::RGBA8
+			if (bound_min.x > bound_max.x) return;
+
+			wk::Point offset((int)std::floor(bound_min.x), (int)std::floor(bound_min.y));
+			CreateCanvas(
+				(uint16_t)std::max<int>((int)std::ceil(bound_max.x) - offset.x, 1),
+				(uint16_t)std::max<int>((int)std::ceil(bound_max.y) - offset.y, 1)
 			);
 
-			for (const FilledElement& element : transformed_elements)
+			// All fills and strokes are drawn to one shared canvas
+			for (size_t i = 0; elements.Size() > i; i++)
 			{
-				for (const FilledElementRegion region : element.fill)
+				StaticElement& element = elements[i];
+				if (!element.IsFilledArea()) continue;
+
+				const FilledElement& filled_element = (const FilledElement&)element;
+				const Animate::DOM::Utils::MATRIX2D& matrix = element.Transformation();
+
+				BLMatrix2D transform(
+					matrix.a * resolution, matrix.b * resolution,
+					matrix.c * resolution, matrix.d * resolution,
+					matrix.tx * resolution - offset.x, matrix.ty * resolution - offset.y
+				);
+				bl_assert(canvas->ctx.setTransform(transform));
+
+				for (const FilledElementRegion& region : filled_element.fill)
 				{
 					if (!IsValidFilledShapeRegion(region)) continue;
 
-					DrawRegionTo(sprite, region, offset);
+					DrawRegion(region, wk::PointF(0, 0), 1.f, true);
+				}
+
+				for (const FilledElementRegion& region : filled_element.stroke)
+				{
+					if (!IsValidFilledShapeRegion(region)) continue;
+
+					DrawRegion(region, wk::PointF(0, 0), 1.f, true);
 				}
 			}
 
+			wk::RawImageRef sprite = canvas->image;
+			ReleaseCanvas();
+
 			// Scale back
 			const Animate::DOM::Utils::MATRIX2D transform = {
 				1.f / resolution,
@@ -442,6 +802,7 @@ namespace sc {
 					// Small workaround to avoid crashes with empty shapes but keep it required
 					flash::MovieClip& movieclip = m_writer.swf.movieclips.emplace_back();
 					movieclip.id = id;
+					m_writer.AddEmptyObject(id);
 
 					return true;
 				}
@@ -460,11 +821,18 @@ namespace sc {
 		}
 
 		void SCShapeWriter::CreateCanvas(const Animate::DOM::Utils::RECT bound, float resolution)
+		{
+			CreateCanvas(
+				std::ceil(bound.topLeft.x - bound.bottomRight.x) * resolution,
+				std::ceil(bound.topLeft.y - bound.bottomRight.y) * resolution
+			);
+		}
+
+		void SCShapeWriter::CreateCanvas(uint16_t width, uint16_t height)
 		{
 			canvas = wk::CreateUnique<RasterizingContext>();
 			canvas->image = wk::CreateRef<wk::RawImage>(
-				std::ceil(bound.topLeft.x - bound.bottomRight.x) * resolution,
-				std::ceil(bound.topLeft.y - bound.bottomRight.y) * resolution,
+				width, height,
 				wk::Image::PixelDepth::RGBA8,
 				wk::Image::ColorSpace::Linear
 			);
@@ -484,13 +852,27 @@ namespace sc {
 			//if (m_vector_graphics.empty()) return;
 		}
 
-		void SCShapeWriter::DrawRegion(const Animate::Publisher::FilledElementRegion& region, wk::PointF offset, float resolution)
+		void SCShapeWriter::DrawRegion(const Animate::Publisher::FilledElementRegion& region, wk::PointF offset, float resolution, bool shared_canvas)
 		{
 			// Contour drawing
 			{
 				BLPath contour;
 				SCShapeWriter::CreatePath(region.contour, offset, contour, resolution);
 
+				// On shared canvas holes are drawn as a part of contour path with even-odd fill rule
+				// so they do not clear anything that was drawn before
+				if (shared_canvas)
+				{
+					for (const auto& hole : region.holes)
+					{
+						BLPath hole_contour;
+						SCShapeWriter::CreatePath(hole, offset, hole_contour, resolution);
+						bl_assert(contour.addPath(hole_contour));
+					}
+
+					canvas->ctx.setFillRule(BLFillRule::BL_FILL_RULE_EVEN_ODD);
+				}
+
 				BLResult result = BL_SUCCESS;
 				if (region.type == FilledElementRegion::ShapeType::SolidColor)
 				{
@@ -540,8 +922,12 @@ namespace sc {
 					result = canvas->ctx.fillPath(contour, pattern);
 				}
 				bl_assert(result);
+
+				canvas->ctx.setFillRule(BLFillRule::BL_FILL_RULE_NON_ZERO);
 			}
 
+			if (shared_canvas) return;
+
 			// Hole drawing
 			{
 				canvas->ctx.setCompOp(BLCompOp::BL_COMP_OP_CLEAR);
@@ -560,49 +946,6 @@ namespace sc {
 			}
 		}
 
-		void SCShapeWriter::DrawRegionTo(
-			const wk::RawImageRef target,
-			const Animate::Publisher::FilledElementRegion& region,
-			wk::Point offset,
-			float resolution
-		)
-		{
-			wk::RawImageRef sprite;
-			wk::Point region_offset;
-			DrawRegion(region, resolution, sprite, region_offset);
-
-			for (uint16_t h = 0; sprite->height() > h; h++)
-			{
-				for (uint16_t w = 0; sprite->width() > w; w++)
-				{
-					auto& source = sprite->at<wk::ColorRGBA>(w, h);
-					if (!source.a) continue;
-
-					uint16_t dstW = w + (region_offset.x - offset.x);
-					uint16_t dstH = h + (region_offset.y - offset.y);
-
-					if (dstW >= target->width() || dstH >= target->height())
-					{
-						continue;
-					}
-
-					auto& dest = target->at<wk::ColorRGBA>(dstW, dstH);
-
-					float alpha_fac = (255 - (float)source.a) / 255;
-					float alpha = (float)source.a + (float)dest.a * alpha_fac;
-
-					float red = (float)source.r + (float)dest.r * alpha_fac;
-					float green = (float)source.g + (float)dest.g * alpha_fac;
-					float blue = (float)source.b + (float)dest.b * alpha_fac;
-
-					dest.r = std::ceil(red);
-					dest.g = std::ceil(green);
-					dest.b = std::ceil(blue);
-					dest.a = std::ceil(alpha);
-				}
-			}
-		}
-
 		void SCShapeWriter::DrawRegion(const Animate::Publisher::FilledElementRegion& region, float resolution, wk::RawImageRef& result, wk::Point& result_offset)
 		{
 			Animate::DOM::Utils::RECT bound = region.Bound();
@@ -733,8 +1076,7 @@ namespace wk::hash
 			if (item.IsSprite())
 			{
 				const sc::Adobe::BitmapItem& sprite = (const sc::Adobe::BitmapItem&)item;
-				const auto& image = sprite.Image();
-				stream.update((const wk::Image&)image);
+				stream.update(sprite.ImageHash());
 			
 				if (sprite.Is9Sliced())
 				{
@@ -4,6 +4,7 @@
 #include "core/math/point.h"
 #include "core/memory/ref.h"
 #include "core/image/raw_image.h"
+#include "core/math/rect.h"
 
 #include <blend2d.h>
 
@@ -27,6 +28,13 @@ namespace sc {
 
 			static inline const float RasterizationResolution = 2.f;
 
+			// Regions with bigger area in pixels are rasterized by tiles
+			static inline const uint32_t SparseRasterizationArea = 1024 * 1024;
+			static inline const uint16_t RasterizationTileSize = 256;
+
+			// Tiles are kept separate only if their area is at least that many times smaller than their joined bound
+			static inline const uint32_t SparseRasterizationRatio = 4;
+
 		public:
 			virtual void AddGraphic(const Animate::Publisher::BitmapElement& item);
 			virtual void AddFilledElement(const Animate::Publisher::FilledElement& shape);
@@ -58,6 +66,32 @@ namespace sc {
 				float resolution = 1.f
 			);
 
+			/// <summary>
+			/// Rasterizes region by fixed size tiles and keeps only tiles with visible pixels.
+			/// Tiles are joined back to one sprite cropped by visible pixels if splitting does not save enough area
+			/// </summary>
+			/// <param name="region">Region itself</param>
+			/// <param name="matrix">Region transform</param>
+			/// <param name="resolution">Draw resolution</param>
+			void AddTiledRasterizedRegion(
+				const Animate::Publisher::FilledElementRegion& region,
+				const Animate::DOM::Utils::MATRIX2D& matrix,
+				float resolution = 1.f
+			);
+
+			/// <summary>
+			/// Adds bitmap to graphic group or replaces it with colorfill quad if image is filled with one color
+			/// </summary>
+			/// <param name="image">Sprite image</param>
+			/// <param name="matrix">Sprite transform</param>
+			/// <param name="rasterized">Is image produced by vector rasterizer</param>
+			void AddBitmapItem(
+				wk::RawImageRef image,
+				const Animate::DOM::Utils::MATRIX2D& matrix,
+				bool rasterized = false,
+				std::optional<std::size_t> image_hash = std::nullopt
+			);
+
 		public:
 			void AddFilledShapeRegion(const Animate::Publisher::FilledElementRegion& region, const Animate::DOM::Utils::MATRIX2D& matrix);
 			bool IsValidFilledShapeRegion(const Animate::Publisher::FilledElementRegion& region);
@@ -66,6 +100,34 @@ namespace sc {
 		public:
 			static void RoundDomRectangle(Animate::DOM::Utils::RECT& rect);
 
+			/// <summary>
+			/// Checks if region is big enough to be rasterized by tiles instead of one canvas
+			/// </summary>
+			/// <param name="bound">Region bound in document coordinates</param>
+			/// <param name="resolution">Rasterization resolution</param>
+			static bool IsSparseRasterizationBound(const Animate::DOM::Utils::RECT& bound, float resolution);
+
+			/// <summary>
+			/// Crops image area to bound of visible pixels
+			/// </summary>
+			/// <param name="image">Source image</param>
+			/// <param name="width">Width of area to crop from</param>
+			/// <param name="height">Height of area to crop from</param>
+			/// <param name="result">Cropped image</param>
+			/// <param name="offset">Offset of cropped image in source</param>
+			/// <returns>False if area has no visible pixels</returns>
+			static bool CropImage(const wk::RawImage& image, uint16_t width, uint16_t height, wk::RawImageRef& result, wk::Point& offset);
+
+			/// <summary>
+			/// Checks if all visible pixels of image are filled with same color
+			/// and form axis-aligned rectangle with optional antialiased border
+			/// </summary>
+			/// <param name="image">Image to check</param>
+			/// <param name="premultiplied">Is image has premultiplied alpha</param>
+			/// <param name="color">Straight alpha fill color</param>
+			/// <param name="bound">Fill rectangle in image pixel coordinates</param>
+			static bool IsUniformColorImage(const wk::RawImage& image, bool premultiplied, wk::ColorRGBA& color, wk::RectF& bound);
+
 		private: // canvas releated functions
 
 			/// <summary>
@@ -75,18 +137,16 @@ namespace sc {
 			void CreateCanvas(const Animate::DOM::Utils::RECT bound, float resolution);
 
 			/// <summary>
-			/// Destroy canvas context and flush drawing
+			/// Create canvas context with given size in pixels
 			/// </summary>
-			void ReleaseCanvas();
+			/// <param name="width"></param>
+			/// <param name="height"></param>
+			void CreateCanvas(uint16_t width, uint16_t height);
 
 			/// <summary>
-			/// Draw region on existing image
+			/// Destroy canvas context and flush drawing
 			/// </summary>
-			/// <param name="image">Draw surface</param>
-			/// <param name="region">Region itself</param>
-			/// <param name="offset">Surface offset</param>
-			/// <param name="resolution">Draw resolution</param>
-			void DrawRegionTo(const wk::RawImageRef image, const Animate::Publisher::FilledElementRegion& region, wk::Point offset, float resolution = 1.f);
+			void ReleaseCanvas();
 
 			/// <summary>
 			/// Draw region in active canvas context
@@ -94,7 +154,8 @@ namespace sc {
 			/// <param name="region">Region itself</param>
 			/// <param name="offset">Region offset</param>
 			/// <param name="resolution">Draw resolution</param>
-			void DrawRegion(const Animate::Publisher::FilledElementRegion& region, wk::PointF offset, float resolution = 1.f);
+			/// <param name="shared_canvas">Canvas already has other regions, so holes must not clear them</param>
+			void DrawRegion(const Animate::Publisher::FilledElementRegion& region, wk::PointF offset, float resolution = 1.f, bool shared_canvas = false);
 
 			/// <summary>
 			/// Draw region
@@ -12,11 +12,50 @@
 
 #include "Reassemble/Object.hpp"
 #include "Reassemble/Atlas.h"
+#include "Optimization/SpriteHull.h"
+#include "Optimization/MatrixBanks.h"
+#include "Optimization/Flattening.h"
+#include "Optimization/ShapeBatching.h"
+#include "Optimization/PrecisionMatrix.h"
+#include "Optimization/AtlasPacking.h"
+
+#include <optional>
 
 using namespace Animate::Publisher;
 
 namespace sc {
 	namespace Adobe {
+		// Pixel format of raw RGBA textures for current quality
+		static std::optional<flash::SWFTexture::PixelFormat> get_raw_pixel_format(const SCConfig& config)
+		{
+			switch (config.textureQuality)
+			{
+			case SCConfig::Quality::Highest:
+				return flash::SWFTexture::PixelFormat::RGBA8;
+			case SCConfig::Quality::High:
+			case SCConfig::Quality::Medium:
+				return flash::SWFTexture::PixelFormat::RGBA4;
+			case SCConfig::Quality::Low:
+				return flash::SWFTexture::PixelFormat::RGB5_A1;
+			default:
+				return std::nullopt;
+			}
+		}
+
+		static bool is_texture_encoded(const SCConfig& config, const flash::SWFTexture& texture)
+		{
+			if (config.textureEncoding != flash::SWFTexture::TextureEncoding::Raw)
+			{
+				return texture.encoding() == flash::SWFTexture::TextureEncoding::KhronosTexture;
+			}
+
+			if (texture.encoding() != flash::SWFTexture::TextureEncoding::Raw) return false;
+			if (texture.image()->base_type() != Image::BasePixelType::RGBA) return true;
+
+			auto pixel_format = get_raw_pixel_format(config);
+			return !pixel_format.has_value() || texture.pixel_format() == pixel_format.value();
+		}
+
 		SCWriter::SCWriter()
 		{
 		}
@@ -55,6 +94,8 @@ namespace sc {
 			default:
 				break;
 			}
+
+			m_modifier_types[id] = modifier.type;
 		}
 
 		SharedTextFieldWriter* SCWriter::AddTextField(Animate::Publisher::SymbolContext& symbol)
@@ -64,48 +105,55 @@ namespace sc {
 
 		uint16_t SCWriter::LoadExternal(fs::path path) {
 			using namespace Animate::DOM;
-			swf.load(path);
 
+			// SupercellSWF::load only accepts path and does not report file version, so header is read by separate stream
+			bool is_sc2 = false;
 			{
 				InputFileStream file(path);
-				if (flash::SupercellSWF::IsSC2(file))
-				{
-					for (auto& shape : swf.shapes)
-					{
-						for (auto& command : shape.commands)
-						{
-							command.sort_advanced_vertices();
-						}
-					}
-				}
+				is_sc2 = flash::SupercellSWF::IsSC2(file);
 			}
 
-			texture_offset = swf.textures.size();
+			swf.load(path);
+
+			// Max id of loaded objects, new symbols get ids after it
 			uint16_t idOffset = 0;
+			auto update_id = [&idOffset](const flash::DisplayObject& object)
+				{
+					if (object.id > idOffset) idOffset = object.id;
+				};
+
+			for (flash::Shape& shape : swf.shapes)
 			{
-				for (flash::MovieClip& object : swf.movieclips) {
-					if (object.id > idOffset) {
-						idOffset = object.id;
-					}
-				}
+				update_id(shape);
+				if (!is_sc2) continue;
 
-				for (flash::MovieClipModifier& object : swf.movieclip_modifiers) {
-					if (object.id > idOffset) {
-						idOffset = object.id;
-					}
+				for (auto& command : shape.commands)
+				{
+					command.sort_advanced_vertices();
 				}
+			}
 
-				for (flash::TextField& object : swf.textfields) {
-					if (object.id > idOffset) {
-						idOffset = object.id;
-					}
-				}
+			for (flash::MovieClip& object : swf.movieclips) update_id(object);
+			for (flash::MovieClipModifier& object : swf.movieclip_modifiers)
+			{
+				update_id(object);
+				m_modifier_types[object.id] = object.type;
+			}
+			for (flash::TextField& object : swf.textfields) update_id(object);
 
-				for (flash::Shape& object : swf.shapes) {
-					if (object.id > idOffset) {
-						idOffset = object.id;
-					}
-				}
+			texture_offset = swf.textures.size();
+
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+			// Scale of loaded pages is not stored in file, so only pages of default scale can be kept.
+			// Lowres textures are generated from the same pages, so their settings must match too
+			bool same_texture_settings =
+				config.textureScaleFactor == 1 &&
+				swf.use_low_resolution == config.hasLowresTexture &&
+				swf.use_multi_resolution == config.hasMultiresTexture;
+
+			if (config.repackAtlas && config.incrementalRepack && same_texture_settings)
+			{
+				flash::hash_page_bitmaps(swf, m_external_page_hashes);
 			}
 
 			return ++idOffset;
@@ -176,9 +224,115 @@ namespace sc {
 			BitmapItem& sprite_item
 		)
 		{
+			using namespace wk::AtlasGenerator;
+
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+
+			Container<Vertex> hull;
+			if (config.spriteHullVertices > 4 && GetSpriteHull(atlas_item, sprite_item, config.spriteHullVertices, hull))
+			{
+				ProcessVertices(shape, hull, atlas_item, sprite_item);
+				return;
+			}
+
 			ProcessVertices(shape, atlas_item.vertices, atlas_item, sprite_item);
 		}
 
+		bool SCWriter::GetSpriteHull(
+			const wk::AtlasGenerator::Item& atlas_item,
+			const BitmapItem& sprite_item,
+			uint8_t max_vertices,
+			wk::AtlasGenerator::Container<wk::AtlasGenerator::Vertex>& result
+		)
+		{
+			using namespace wk::AtlasGenerator;
+
+			const Container<Vertex>& vertices = atlas_item.vertices;
+			if (3 > vertices.size()) return false;
+
+			HullPolygon polygon;
+			polygon.reserve(vertices.size());
+			for (const Vertex& vertex : vertices)
+			{
+				polygon.emplace_back(vertex.xy.x, vertex.xy.y);
+			}
+
+			auto cached = m_sprite_hulls.find(sprite_item.ImageHash());
+			if (cached == m_sprite_hulls.end())
+			{
+				SpriteHull sprite_hull;
+				if (!build_sprite_hull(sprite_item.Image(), max_vertices, sprite_hull.polygon))
+				{
+					sprite_hull.polygon.clear();
+				}
+
+				cached = m_sprite_hulls.emplace(sprite_item.ImageHash(), std::move(sprite_hull)).first;
+			}
+
+			SpriteHull& sprite_hull = cached->second;
+			const HullPolygon& hull = sprite_hull.polygon;
+			if (hull.empty()) return false;
+
+			// Hull should give a noticeable profit, otherwise keep the original polygon
+			float polygon_size = polygon_area(polygon);
+			float hull_size = polygon_area(hull);
+			if (hull_size >= polygon_size * 0.9f) return false;
+
+			// Atlas contains only pixels covered by original polygon
+			for (const wk::PointF& point : hull)
+			{
+				if (!point_inside_polygon(polygon, point)) return false;
+			}
+
+			// Affine transformation from sprite coordinates to atlas item coordinates
+			// which is calculated from first three non-collinear vertices of original polygon
+			const Vertex& v0 = vertices[0];
+			for (size_t i = 1; vertices.size() > i; i++)
+			{
+				for (size_t t = i + 1; vertices.size() > t; t++)
+				{
+					const Vertex& v1 = vertices[i];
+					const Vertex& v2 = vertices[t];
+
+					float x1 = v1.xy.x - v0.xy.x, y1 = v1.xy.y - v0.xy.y;
+					float x2 = v2.xy.x - v0.xy.x, y2 = v2.xy.y - v0.xy.y;
+					float determinant = x1 * y2 - x2 * y1;
+					if (std::abs(determinant) < 1e-3f) continue;
+
+					float u1 = (float)v1.uv.u - v0.uv.u, w1 = (float)v1.uv.v - v0.uv.v;
+					float u2 = (float)v2.uv.u - v0.uv.u, w2 = (float)v2.uv.v - v0.uv.v;
+
+					float ua = (u1 * y2 - u2 * y1) / determinant;
+					float ub = (u2 * x1 - u1 * x2) / determinant;
+					float va = (w1 * y2 - w2 * y1) / determinant;
+					float vb = (w2 * x1 - w1 * x2) / determinant;
+
+					for (const wk::PointF& point : hull)
+					{
+						float dx = point.x - v0.xy.x;
+						float dy = point.y - v0.xy.y;
+
+						Vertex& vertex = result.emplace_back(v0);
+						vertex.xy.x = point.x;
+						vertex.xy.y = point.y;
+						vertex.uv.u = (uint16_t)std::round(v0.uv.u + ua * dx + ub * dy);
+						vertex.uv.v = (uint16_t)std::round(v0.uv.v + va * dx + vb * dy);
+					}
+
+					if (!sprite_hull.counted)
+					{
+						m_hull_saved_area += polygon_size - hull_size;
+						m_hull_added_vertices += (int64_t)hull.size() - (int64_t)vertices.size();
+						sprite_hull.counted = true;
+					}
+
+					return true;
+				}
+			}
+
+			return false;
+		}
+
 		void SCWriter::ProcessSlicedItem(
 			flash::Shape& shape,
 			wk::AtlasGenerator::Item& atlas_item,
@@ -256,6 +410,9 @@ namespace sc {
 
 			std::vector<AtlasGenerator::Item> items;
 
+			// Image size of each item for packing strategies
+			std::vector<std::pair<uint32_t, uint32_t>> item_sizes;
+
 			for (GraphicGroup& group : m_graphic_groups)
 			{
 				for (size_t i = 0; group.Size() > i; i++)
@@ -270,6 +427,7 @@ namespace sc {
 							sprite_item.Image(),
 							item.Is9Sliced()
 						);
+						item_sizes.emplace_back(sprite_item.Image()->width(), sprite_item.Image()->height());
 
 						if (sprite_item.IsRasterizedVector() || item.Is9Sliced())
 						{
@@ -282,6 +440,7 @@ namespace sc {
 						FilledItem& filled_item = (FilledItem&)item;
 
 						items.emplace_back(filled_item.Color());
+						item_sizes.emplace_back(1, 1);
 					}
 					else
 					{
@@ -290,27 +449,34 @@ namespace sc {
 				}
 			}
 
-			AtlasGenerator::Config generator_config(
-				config.textureMaxWidth,
-				config.textureMaxHeight,
-				1.f / config.textureScaleFactor,
-				2
-			);
+			flash::AtlasPackingSettings packing_settings;
+			packing_settings.max_width = config.textureMaxWidth;
+			packing_settings.max_height = config.textureMaxHeight;
+			packing_settings.scale = 1.f / config.textureScaleFactor;
+			packing_settings.extrude = 2;
+			packing_settings.strategies = config.atlasPackingStrategies;
 
 			int itemCount = (int)items.size();
 			status->SetRange(itemCount);
 
-			generator_config.progress = [&status](uint32_t value) {
+			packing_settings.progress = [&status](uint32_t value) {
 				status->SetProgress(value);
 			};
 
-			AtlasGenerator::Generator generator(generator_config);
+			std::vector<flash::AtlasPackingItem> packing_items;
+			packing_items.reserve(items.size());
+			for (size_t i = 0; items.size() > i; i++)
+			{
+				packing_items.push_back({ items[i], item_sizes[i].first, item_sizes[i].second });
+			}
 
+			flash::AtlasPackingResult packing;
 			uint16_t texture_count = 0;
 
 			try
 			{
-				texture_count = generator.generate(items);
+				flash::pack_atlas(packing_items, packing_settings, packing);
+				texture_count = (uint16_t)packing.atlas_count;
 			}
 			catch (const AtlasGenerator::PackagingException& exception)
 			{
@@ -380,8 +546,13 @@ namespace sc {
 
 			context.Window()->DestroyStatusBar(status);
 
+			if (packing.strategy != 0)
+			{
+				context.logger->info("Atlas packing: strategy {} gave {} pages", packing.strategy, packing.atlas_count);
+			}
+
 			for (uint16_t i = 0; texture_count > i; i++) {
-				wk::RawImage& atlas = generator.get_atlas(i);
+				wk::RawImage& atlas = packing.generator->get_atlas(i);
 
 				flash::SWFTexture& texture = swf.textures.emplace_back();
 				texture.load_from_image(atlas);
@@ -428,34 +599,49 @@ namespace sc {
 				}
 			}
 
+			if (config.spriteHullVertices > 4)
+			{
+				context.logger->info(
+					"Sprite hulls: saved {} px of rasterized area with {} additional vertices",
+					(uint64_t)m_hull_saved_area, m_hull_added_vertices
+				);
+			}
+
+			// Pages that were kept from external file are encoded again only if their encoding differs from current one
+			size_t preserved_textures = 0;
 			if (config.exportToExternal && config.repackAtlas)
 			{
-				flash::repack_atlas(swf);
+				flash::RepackOptions options;
+				if (config.incrementalRepack)
+				{
+					options.external_page_hashes = m_external_page_hashes;
+				}
+				options.max_width = config.textureMaxWidth;
+				options.max_height = config.textureMaxHeight;
+				options.packing_strategies = config.atlasPackingStrategies;
+
+				preserved_textures = flash::repack_atlas(swf, options);
+				if (preserved_textures > 0)
+				{
+					context.logger->info("Repack: {} texture pages kept without changes", preserved_textures);
+				}
 			}
 
 			wk::parallel::enumerate(
 				swf.textures.begin(),
 				swf.textures.end(),
-				[&config](flash::SWFTexture& texture, size_t)
+				[&config, preserved_textures](flash::SWFTexture& texture, size_t index)
 				{
+					if (preserved_textures > index && is_texture_encoded(config, texture)) return;
+
 					if (config.textureEncoding == flash::SWFTexture::TextureEncoding::Raw)
 					{
 						if (texture.image()->base_type() == Image::BasePixelType::RGBA)
 						{
-							switch (config.textureQuality)
+							auto pixel_format = get_raw_pixel_format(config);
+							if (pixel_format.has_value())
 							{
-							case SCConfig::Quality::Highest:
-								texture.pixel_format(flash::SWFTexture::PixelFormat::RGBA8);
-								break;
-							case SCConfig::Quality::High:
-							case SCConfig::Quality::Medium:
-								texture.pixel_format(flash::SWFTexture::PixelFormat::RGBA4);
-								break;
-							case SCConfig::Quality::Low:
-								texture.pixel_format(flash::SWFTexture::PixelFormat::RGB5_A1);
-								break;
-							default:
-								break;
+								texture.pixel_format(pixel_format.value());
 							}
 						}
 					}
@@ -497,21 +683,77 @@ namespace sc {
 				END
 			);
 
+			if (culled_elements > 0)
+			{
+				context.logger->info("Culled invisible frame elements: {}", culled_elements);
+			}
+
+			FinalizeFramesReport();
+
+			// Passes below change banks in place without lookup indices
+			m_bank_indices.clear();
+
+			if (config.flattenWrapperMovieclips)
+			{
+				flash::FlatteningStatistics statistics;
+				if (flash::flatten_wrappers(swf, statistics))
+				{
+					context.logger->info(
+						"Inlined wrapper instances: {}, removed wrappers: {}",
+						statistics.inlined_instances, statistics.removed_wrappers
+					);
+				}
+			}
+
+			flash::RemoveUnusedStatistics unused;
 			if (config.exportToExternal)
 			{
-				flash::remove_unused(swf);
+				flash::remove_unused(swf, unused);
 			}
 
 			status->SetProgress(ATLAS_FINALIZE);
 			status->SetStatusLabel(context.locale.GetString("TID_STATUS_TEXTURE_SAVE"));
 			FinalizeAtlas();
 
+			// Shapes get final commands only after atlas finalize
+			if (config.batchStaticShapes)
+			{
+				flash::ShapeBatchingStatistics statistics;
+				if (flash::batch_static_shapes(swf, statistics))
+				{
+					context.logger->info(
+						"Batched static shape instances: {} into {} shapes, removed shapes: {}",
+						statistics.merged_instances, statistics.created_shapes, statistics.removed_shapes
+					);
+				}
+			}
+
+			flash::remove_unused_resources(swf, unused);
+			if (unused.objects > 0 || unused.textures > 0 || unused.matrices > 0 || unused.color_transforms > 0 || unused.banks > 0)
+			{
+				context.logger->info(
+					"Removed unused objects: {}, textures: {}, matrices: {}, color transforms: {}, banks: {}",
+					unused.objects, unused.textures, unused.matrices, unused.color_transforms, unused.banks
+				);
+			}
+
+			if (config.compactObjectIds)
+			{
+				size_t changed_ids = flash::compact_object_ids(swf);
+				if (changed_ids > 0)
+				{
+					context.logger->info("Compacted display object ids: {} objects renumbered", changed_ids);
+				}
+			}
+
+			FinalizeMatrixBanks();
+
 			swf.use_external_texture = config.hasExternalTexture;
 			swf.use_low_resolution = config.hasLowresTexture;
 			swf.use_multi_resolution = config.hasMultiresTexture;
 			swf.multi_resolution_suffix = flash::SWFString(config.multiResolutionSuffix);
 			swf.low_resolution_suffix = flash::SWFString(config.lowResolutionSuffix);
-			swf.use_precision_matrix = config.hasPrecisionMatrices;
+			FinalizePrecisionMatrices();
 			swf.save_custom_property = config.writeCustomProperties;
 
 			// Raw textures can be stored only inside texture files
@@ -547,13 +789,114 @@ namespace sc {
 			context.Window()->DestroyStatusBar(status);
 		}
 
-		wk::RawImageRef SCWriter::GetBitmap(const BitmapElement& item)
+		void SCWriter::FinalizeFramesReport()
+		{
+			SCPlugin& context = SCPlugin::Instance();
+
+			if (collapsed_movieclips > 0)
+			{
+				context.logger->info("Movieclips collapsed to single frame: {}", collapsed_movieclips);
+			}
+
+			if (identical_frame_runs.empty()) return;
+
+			std::sort(
+				identical_frame_runs.begin(), identical_frame_runs.end(),
+				[](const IdenticalFramesRun& a, const IdenticalFramesRun& b)
+				{
+					return a.length > b.length;
+				}
+			);
+
+			context.logger->info("Longest runs of identical frames:");
+			for (size_t i = 0; identical_frame_runs.size() > i && IdenticalFramesReportCount > i; i++)
+			{
+				const IdenticalFramesRun& run = identical_frame_runs[i];
+
+				context.logger->info(
+					"	{}: frames {} - {} ({} frames)",
+					FCM::Locale::ToUtf8(run.symbol),
+					run.first_frame + 1, run.first_frame + run.length, run.length
+				);
+			}
+		}
+
+		void SCWriter::FinalizeMatrixBanks()
+		{
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+			SCPlugin& context = SCPlugin::Instance();
+
+			if (config.matrixTranslationTolerance > 0 || config.matrixScaleTolerance > 0 || config.colorTransformTolerance > 0)
+			{
+				context.logger->info(
+					"Transform quantization max error: translation {} twips, scale {}, color {}",
+					quantization.max_translation_error, quantization.max_scale_error, quantization.max_color_error
+				);
+			}
+
+			flash::MatrixBankStatistics statistics;
+			if (flash::optimize_bank_assignment(swf, statistics))
+			{
+				context.logger->info(
+					"Matrix banks: {} -> {} banks, {} -> {} entries",
+					statistics.banks_before, statistics.banks_after,
+					statistics.entries_before, statistics.entries_after
+				);
+			}
+
+			// Banks were rebuilt, so lookup indices are not valid anymore
+			m_bank_indices.clear();
+		}
+
+		void SCWriter::FinalizePrecisionMatrices()
+		{
+			const SCConfig& config = SCPlugin::Publisher::ActiveConfig();
+			SCPlugin& context = SCPlugin::Instance();
+
+			swf.use_precision_matrix = config.hasPrecisionMatrices;
+
+			// Old runtimes can't read precision matrices
+			if (config.hasPrecisionMatrices || !config.autoPrecisionMatrices || config.backwardCompatibility) return;
+
+			flash::MatrixPrecisionReport report;
+			flash::analyze_matrix_precision(swf, report);
+
+			swf.use_precision_matrix = report.max_error > PrecisionMatrixMaxError;
+			context.logger->info(
+				"Precision matrices: {}, max error of compact matrices: {} px",
+				swf.use_precision_matrix ? "enabled" : "disabled", report.max_error
+			);
+
+			if (!swf.use_precision_matrix) return;
+
+			std::unordered_map<uint16_t, std::string> export_names;
+			for (const flash::ExportName& export_name : swf.exports)
+			{
+				export_names.emplace(export_name.id, export_name.name.string());
+			}
+
+			for (size_t i = 0; report.movieclips.size() > i && PrecisionMatrixReportCount > i; i++)
+			{
+				auto& [id, error] = report.movieclips[i];
+				if (PrecisionMatrixMaxError >= error) break;
+
+				auto name_it = export_names.find(id);
+				context.logger->info(
+					"	Movieclip {} {}: {} px",
+					id, name_it != export_names.end() ? name_it->second : "", error
+				);
+			}
+		}
+
+		wk::RawImageRef SCWriter::GetBitmap(const BitmapElement& item, std::size_t& image_hash)
 		{
 			const std::u16string& name = item.Name();
 
-			if (m_cached_images.count(name))
+			auto cached = m_cached_images.find(name);
+			if (cached != m_cached_images.end())
 			{
-				return m_cached_images[name];
+				image_hash = cached->second.hash;
+				return cached->second.image;
 			}
 
 			item.ExportImage(sprite_temp_path);
@@ -561,7 +904,9 @@ namespace sc {
 			wk::RawImageRef image;
 			wk::InputFileStream file(sprite_temp_path);
 			wk::stb::load_image(file, image);
-			m_cached_images[name] = image;
+
+			image_hash = BitmapItem::HashImage(*image);
+			m_cached_images[name] = { image, image_hash };
 
 			return image;
 		}
@@ -570,5 +915,37 @@ namespace sc {
 		{
 			m_graphic_groups.push_back(group);
 		}
+
+		void SCWriter::AddEmptyObject(uint16_t id)
+		{
+			m_empty_objects.insert(id);
+		}
+
+		bool SCWriter::IsEmptyObject(uint16_t id) const
+		{
+			return m_empty_objects.count(id) != 0;
+		}
+
+		bool SCWriter::GetModifierType(uint16_t id, flash::MovieClipModifier::Type& type) const
+		{
+			auto it = m_modifier_types.find(id);
+			if (it == m_modifier_types.end()) return false;
+
+			type = it->second;
+			return true;
+		}
+
+		MatrixBankIndex& SCWriter::GetMatrixBankIndex(size_t bank_index)
+		{
+			if (swf.matrixBanks.size() > m_bank_indices.size())
+			{
+				m_bank_indices.resize(swf.matrixBanks.size());
+			}
+
+			MatrixBankIndex& index = m_bank_indices[bank_index];
+			index.sync(swf.matrixBanks[bank_index]);
+
+			return index;
+		}
 	}
 }
\ No newline at end of file
@@ -6,11 +6,15 @@
 #include "core/memory/ref.h"
 
 #include <filesystem>
+#include <unordered_set>
 
 #include "Writer/GraphicItem/GraphicItem.h"
 #include "Writer/GraphicItem/FilledItem.h"
 #include "Writer/GraphicItem/SlicedItem.h"
 #include "Writer/GraphicItem/SpriteItem.h"
+#include "Writer/MatrixBankIndex.h"
+#include "Writer/Optimization/TransformQuantization.h"
+#include "Writer/Optimization/SpriteHull.h"
 
 namespace sc {
 	namespace Adobe {
@@ -18,6 +22,26 @@ namespace sc {
 		public:
 			using GraphicGroup = Animate::Publisher::StaticElementsGroup;
 
+			struct IdenticalFramesRun
+			{
+				std::u16string symbol;
+				uint32_t first_frame = 0;
+				uint32_t length = 0;
+			};
+
+			// Min length of identical frames run that goes to publish report
+			static constexpr uint32_t IdenticalFramesReportLength = 10;
+
+			// Max count of identical frames runs in publish report
+			static constexpr size_t IdenticalFramesReportCount = 10;
+
+			// Max displacement in pixels caused by compact matrices that is allowed without precision matrices.
+			// Quarter of pixel stays below half pixel sampling step, it is reached by content about 512 px away from origin
+			static constexpr float PrecisionMatrixMaxError = 0.25f;
+
+			// Max count of movieclips in precision matrices report
+			static constexpr size_t PrecisionMatrixReportCount = 5;
+
 		public:
 			SCWriter();
 			virtual ~SCWriter();
@@ -39,16 +63,46 @@ namespace sc {
 			flash::SupercellSWF swf;
 			size_t texture_offset = 0;
 
+			// Max errors of transform quantization from all movieclips
+			flash::TransformQuantization quantization;
+
+			// Count of frame elements that were skipped as invisible
+			size_t culled_elements = 0;
+
+			// Count of movieclips that were collapsed to single frame
+			size_t collapsed_movieclips = 0;
+
+			// Long runs of identical frames in movieclips that were not collapsed
+			std::vector<IdenticalFramesRun> identical_frame_runs;
+
 		public:
-			wk::RawImageRef GetBitmap(const Animate::Publisher::BitmapElement& item);
+			// Image is loaded and hashed only once for each library bitmap
+			wk::RawImageRef GetBitmap(const Animate::Publisher::BitmapElement& item, std::size_t& image_hash);
 
 			void AddGraphicGroup(const GraphicGroup& group);
 
+			// Objects that have nothing to draw, instances of them can be skipped
+			void AddEmptyObject(uint16_t id);
+			bool IsEmptyObject(uint16_t id) const;
+
+			bool GetModifierType(uint16_t id, flash::MovieClipModifier::Type& type) const;
+
+			// Returns lookup index of swf matrix bank, synced with current bank content
+			MatrixBankIndex& GetMatrixBankIndex(size_t bank_index);
+
 		public:
 			uint16_t LoadExternal(fs::path path);
 
 			void FinalizeAtlas();
 
+			void FinalizeFramesReport();
+
+			// Whole document optimizations of matrix banks
+			void FinalizeMatrixBanks();
+
+			// Enables precision matrices when compact ones move content too far
+			void FinalizePrecisionMatrices();
+
 			// Some functions for atlas finalize
 
 			void ProcessDrawCommand(
@@ -70,6 +124,13 @@ namespace sc {
 				BitmapItem& sprite_item
 			);
 
+			bool GetSpriteHull(
+				const wk::AtlasGenerator::Item& atlas_item,
+				const BitmapItem& sprite_item,
+				uint8_t max_vertices,
+				wk::AtlasGenerator::Container<wk::AtlasGenerator::Vertex>& result
+			);
+
 			void ProcessFilledItem(
 				flash::Shape& shape,
 				wk::AtlasGenerator::Item& atlas_item,
@@ -87,8 +148,42 @@ namespace sc {
 			// Represents swf shapes and must have the same size as shapes vector
 			std::vector<GraphicGroup> m_graphic_groups;
 
+			struct CachedImage
+			{
+				wk::RawImageRef image;
+				std::size_t hash = 0;
+			};
+
 			// Name / Image
-			std::unordered_map<std::u16string, wk::RawImageRef> m_cached_images;
+			std::unordered_map<std::u16string, CachedImage> m_cached_images;
+
+			// Lookup indices for swf matrix banks
+			std::vector<MatrixBankIndex> m_bank_indices;
+
+			std::unordered_set<uint16_t> m_empty_objects;
+
+			// Modifier id / Type, filled together with swf modifiers
+			std::unordered_map<uint16_t, flash::MovieClipModifier::Type> m_modifier_types;
+
+			// Hash of unique bitmaps on each texture page of external file right after loading.
+			// Empty if texture settings of external file differ from current ones
+			std::vector<std::size_t> m_external_page_hashes;
+
+			struct SpriteHull
+			{
+				// Empty if image has no usable hull
+				HullPolygon polygon;
+
+				// Statistics are counted only for first item that uses hull
+				bool counted = false;
+			};
+
+			// Image hash / Hull. Hull depends only on image content, so items with identical images build it once
+			std::unordered_map<std::size_t, SpriteHull> m_sprite_hulls;
+
+			// Sprite hull statistics
+			float m_hull_saved_area = 0;
+			int64_t m_hull_added_vertices = 0;
 		};
 	}
 }
\ No newline at end of file
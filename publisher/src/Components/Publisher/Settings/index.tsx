@@ -8,6 +8,7 @@ import BoolField from "../../Shared/BoolField";
 import FileField from "../../Shared/FileField";
 import { useState } from "react";
 import OtherSettings from "./others";
+import OptimizationSettings from "./optimization";
 import { GetPublishContext } from "../../../Context";
 
 export default function SettingsMenu() {
@@ -78,6 +79,22 @@ export default function SettingsMenu() {
         }
     ).render()
 
+    const incrementalRepack = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_INCREMENTAL_REPACK"),
+            keyName: "incremental_repack_select",
+            defaultValue: Settings.getParam("incrementalRepack"),
+            style: {
+                marginLeft: "2%",
+                marginBottom: "10px",
+                display: "flex",
+                alignItems: "center"
+            },
+            callback: value => (Settings.setParam("incrementalRepack", value)),
+            tip_tid: "TID_SWF_INCREMENTAL_REPACK_TIP"
+        }
+    ).render()
+
     return SubMenu(
         Locale.Get("TID_ADDITIONAL_SETTINGS_LABEL"),
         "additional_settings",
@@ -87,8 +104,10 @@ export default function SettingsMenu() {
         exportToExternal,
         isExportToExternal ? externalFilePath : undefined,
         isExportToExternal ? repackAtlas : undefined,
+        isExportToExternal ? incrementalRepack : undefined,
         is_sc1 ? backwardCompatibility : undefined,
         TextureSettings(),
+        OptimizationSettings(),
         OtherSettings()
     )
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+import Locale from "../../../Localization";
+import BoolField from "../../Shared/BoolField";
+import EnumField from "../../Shared/EnumField";
+import SubMenu from "../../Shared/SubMenu";
+import {
+    AtlasPackingStrategies,
+    ColorTransformTolerance,
+    MatrixScaleTolerance,
+    MatrixTranslationTolerance,
+    Settings,
+    SpriteHullVertices,
+    TargetFrameRates
+} from "../../../PublisherSettings";
+
+export default function OptimizationSettings() {
+    const spriteHullVertices = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_SPRITE_HULL_VERTICES"),
+        keyName: "sprite_hull_vertices_select",
+        enumeration: SpriteHullVertices,
+        defaultValue: SpriteHullVertices.indexOf(Settings.getParam("spriteHullVertices")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("spriteHullVertices", SpriteHullVertices[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_SPRITE_HULL_VERTICES_TIP"
+    }).render();
+
+    const matrixTranslationTolerance = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_MATRIX_TRANSLATION_TOLERANCE"),
+        keyName: "matrix_translation_tolerance_select",
+        enumeration: MatrixTranslationTolerance,
+        defaultValue: MatrixTranslationTolerance.indexOf(Settings.getParam("matrixTranslationTolerance")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("matrixTranslationTolerance", MatrixTranslationTolerance[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_MATRIX_TRANSLATION_TOLERANCE_TIP"
+    }).render();
+
+    const matrixScaleTolerance = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_MATRIX_SCALE_TOLERANCE"),
+        keyName: "matrix_scale_tolerance_select",
+        enumeration: MatrixScaleTolerance,
+        defaultValue: MatrixScaleTolerance.indexOf(Settings.getParam("matrixScaleTolerance")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("matrixScaleTolerance", MatrixScaleTolerance[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_MATRIX_SCALE_TOLERANCE_TIP"
+    }).render();
+
+    const colorTransformTolerance = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_COLOR_TRANSFORM_TOLERANCE"),
+        keyName: "color_transform_tolerance_select",
+        enumeration: ColorTransformTolerance,
+        defaultValue: ColorTransformTolerance.indexOf(Settings.getParam("colorTransformTolerance")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("colorTransformTolerance", ColorTransformTolerance[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_COLOR_TRANSFORM_TOLERANCE_TIP"
+    }).render();
+
+    const collapseStaticMovieclips = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_SETTINGS_COLLAPSE_STATIC_MOVIECLIPS"),
+            keyName: "collapse_static_movieclips",
+            defaultValue: Settings.getParam("collapseStaticMovieclips"),
+            style: {
+                display: "flex",
+                alignItems: "center",
+                marginBottom: "10px"
+            },
+            callback: value => (Settings.setParam("collapseStaticMovieclips", value)),
+            tip_tid: "TID_SWF_SETTINGS_COLLAPSE_STATIC_MOVIECLIPS_TIP"
+        }
+    ).render();
+
+    const flattenWrapperMovieclips = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_SETTINGS_FLATTEN_WRAPPER_MOVIECLIPS"),
+            keyName: "flatten_wrapper_movieclips",
+            defaultValue: Settings.getParam("flattenWrapperMovieclips"),
+            style: {
+                display: "flex",
+                alignItems: "center",
+                marginBottom: "10px"
+            },
+            callback: value => (Settings.setParam("flattenWrapperMovieclips", value)),
+            tip_tid: "TID_SWF_SETTINGS_FLATTEN_WRAPPER_MOVIECLIPS_TIP"
+        }
+    ).render();
+
+    const batchStaticShapes = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_SETTINGS_BATCH_STATIC_SHAPES"),
+            keyName: "batch_static_shapes",
+            defaultValue: Settings.getParam("batchStaticShapes"),
+            style: {
+                display: "flex",
+                alignItems: "center",
+                marginBottom: "10px"
+            },
+            callback: value => (Settings.setParam("batchStaticShapes", value)),
+            tip_tid: "TID_SWF_SETTINGS_BATCH_STATIC_SHAPES_TIP"
+        }
+    ).render();
+
+    const autoPrecisionMatrices = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_SETTINGS_AUTO_PRECISION_MATRIX"),
+            keyName: "auto_precision_matrix",
+            defaultValue: Settings.getParam("autoPrecisionMatrices"),
+            style: {
+                display: "flex",
+                alignItems: "center",
+                marginBottom: "10px"
+            },
+            callback: value => (Settings.setParam("autoPrecisionMatrices", value)),
+            tip_tid: "TID_SWF_SETTINGS_AUTO_PRECISION_MATRIX_TIP"
+        }
+    ).render();
+
+    const compactObjectIds = new BoolField(
+        {
+            name: Locale.Get("TID_SWF_SETTINGS_COMPACT_OBJECT_IDS"),
+            keyName: "compact_object_ids",
+            defaultValue: Settings.getParam("compactObjectIds"),
+            style: {
+                display: "flex",
+                alignItems: "center",
+                marginBottom: "10px"
+            },
+            callback: value => (Settings.setParam("compactObjectIds", value)),
+            tip_tid: "TID_SWF_SETTINGS_COMPACT_OBJECT_IDS_TIP"
+        }
+    ).render();
+
+    const targetFrameRate = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_TARGET_FRAME_RATE"),
+        keyName: "target_frame_rate_select",
+        enumeration: TargetFrameRates,
+        defaultValue: TargetFrameRates.indexOf(Settings.getParam("targetFrameRate")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("targetFrameRate", TargetFrameRates[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_TARGET_FRAME_RATE_TIP"
+    }).render();
+
+    const atlasPackingStrategies = new EnumField({
+        name: Locale.Get("TID_SWF_SETTINGS_ATLAS_PACKING_STRATEGIES"),
+        keyName: "atlas_packing_strategies_select",
+        enumeration: AtlasPackingStrategies,
+        defaultValue: AtlasPackingStrategies.indexOf(Settings.getParam("atlasPackingStrategies")) as never,
+        style: {
+            display: "flex",
+            alignItems: "center",
+            marginBottom: "10px"
+        },
+        callback: value => (Settings.setParam("atlasPackingStrategies", AtlasPackingStrategies[value as never])),
+        tip_tid: "TID_SWF_SETTINGS_ATLAS_PACKING_STRATEGIES_TIP"
+    }).render();
+
+    return SubMenu(
+        Locale.Get("TID_OPTIMIZATION_LABEL"),
+        "optimization_settings",
+        {
+            marginBottom: "6px"
+        },
+        spriteHullVertices,
+        matrixTranslationTolerance,
+        matrixScaleTolerance,
+        colorTransformTolerance,
+        collapseStaticMovieclips,
+        flattenWrapperMovieclips,
+        batchStaticShapes,
+        autoPrecisionMatrices,
+        compactObjectIds,
+        targetFrameRate,
+        atlasPackingStrategies
+    )
+}
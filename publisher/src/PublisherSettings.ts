@@ -43,6 +43,56 @@ export enum SWFType {
     SC2
 }
 
+export const SpriteHullVertices = [
+    4,
+    6,
+    8,
+    12,
+    16
+]
+
+// In twips
+export const MatrixTranslationTolerance = [
+    0,
+    0.5,
+    1,
+    2,
+    5
+]
+
+export const MatrixScaleTolerance = [
+    0,
+    0.0001,
+    0.0005,
+    0.001,
+    0.005
+]
+
+// 0 keeps original frame rate
+export const TargetFrameRates = [
+    0,
+    12,
+    15,
+    20,
+    24,
+    30
+]
+
+export const AtlasPackingStrategies = [
+    1,
+    2,
+    3,
+    4,
+    5
+]
+
+export const ColorTransformTolerance = [
+    0,
+    1,
+    2,
+    4
+]
+
 type PublisherSettingsData = {
     //Basic settings
     output: string,
@@ -59,6 +109,7 @@ type PublisherSettingsData = {
     exportToExternal: boolean,
     exportToExternalPath: string,
     repackAtlas: boolean,
+    incrementalRepack: boolean,
 
     // Texture category
     hasExternalTexture: boolean,
@@ -73,6 +124,19 @@ type PublisherSettingsData = {
     textureScaleFactor: TextureScaleFactor
     textureMaxWidth: number,
     textureMaxHeight: number,
+
+    // Optimization category
+    spriteHullVertices: number,
+    matrixTranslationTolerance: number,
+    matrixScaleTolerance: number,
+    colorTransformTolerance: number,
+    collapseStaticMovieclips: boolean,
+    flattenWrapperMovieclips: boolean,
+    batchStaticShapes: boolean,
+    autoPrecisionMatrices: boolean,
+    compactObjectIds: boolean,
+    targetFrameRate: number,
+    atlasPackingStrategies: number,
 }
 
 const PublisherDefaultSettings : PublisherSettingsData = 
@@ -89,6 +153,7 @@ const PublisherDefaultSettings : PublisherSettingsData =
     exportToExternal: false,
     exportToExternalPath: "",
     repackAtlas: true,
+    incrementalRepack: true,
 
     // Textures
     hasExternalTexture: true,
@@ -103,6 +168,19 @@ const PublisherDefaultSettings : PublisherSettingsData =
     textureScaleFactor: TextureScaleFactor["x1.0"],
     textureMaxWidth: 4096,
     textureMaxHeight: 4096,
+
+    // Optimization
+    spriteHullVertices: 4,
+    matrixTranslationTolerance: 0,
+    matrixScaleTolerance: 0,
+    colorTransformTolerance: 0,
+    collapseStaticMovieclips: false,
+    flattenWrapperMovieclips: false,
+    batchStaticShapes: false,
+    autoPrecisionMatrices: true,
+    compactObjectIds: true,
+    targetFrameRate: 0,
+    atlasPackingStrategies: 1,
 }
 
 export class PublisherSettings {